@@ -1,5 +1,66 @@
-namespace glm
+namespace glm{
+namespace detail
 {
+	template<typename T, qualifier Q, bool Aligned>
+	struct compute_translate
+	{
+		GLM_FUNC_QUALIFIER GLM_CONSTEXPR static mat<4, 4, T, Q> call(mat<4, 4, T, Q> const& m, vec<3, T, Q> const& v)
+		{
+			mat<4, 4, T, Q> Result(m);
+			Result[3] = m[0] * v[0] + m[1] * v[1] + m[2] * v[2] + m[3];
+			return Result;
+		}
+	};
+
+	template<typename T, qualifier Q, bool Aligned>
+	struct compute_rotate
+	{
+		GLM_FUNC_QUALIFIER static mat<4, 4, T, Q> call(mat<4, 4, T, Q> const& m, T angle, vec<3, T, Q> const& v)
+		{
+			T const a = angle;
+			T const c = cos(a);
+			T const s = sin(a);
+
+			vec<3, T, Q> axis(normalize(v));
+			vec<3, T, Q> temp((T(1) - c) * axis);
+
+			mat<4, 4, T, Q> Rotate;
+			Rotate[0][0] = c + temp[0] * axis[0];
+			Rotate[0][1] = temp[0] * axis[1] + s * axis[2];
+			Rotate[0][2] = temp[0] * axis[2] - s * axis[1];
+
+			Rotate[1][0] = temp[1] * axis[0] - s * axis[2];
+			Rotate[1][1] = c + temp[1] * axis[1];
+			Rotate[1][2] = temp[1] * axis[2] + s * axis[0];
+
+			Rotate[2][0] = temp[2] * axis[0] + s * axis[1];
+			Rotate[2][1] = temp[2] * axis[1] - s * axis[0];
+			Rotate[2][2] = c + temp[2] * axis[2];
+
+			mat<4, 4, T, Q> Result;
+			Result[0] = m[0] * Rotate[0][0] + m[1] * Rotate[0][1] + m[2] * Rotate[0][2];
+			Result[1] = m[0] * Rotate[1][0] + m[1] * Rotate[1][1] + m[2] * Rotate[1][2];
+			Result[2] = m[0] * Rotate[2][0] + m[1] * Rotate[2][1] + m[2] * Rotate[2][2];
+			Result[3] = m[3];
+			return Result;
+		}
+	};
+
+	template<typename T, qualifier Q, bool Aligned>
+	struct compute_scale
+	{
+		GLM_FUNC_QUALIFIER static mat<4, 4, T, Q> call(mat<4, 4, T, Q> const& m, vec<3, T, Q> const& v)
+		{
+			mat<4, 4, T, Q> Result;
+			Result[0] = m[0] * v[0];
+			Result[1] = m[1] * v[1];
+			Result[2] = m[2] * v[2];
+			Result[3] = m[3];
+			return Result;
+		}
+	};
+}//namespace detail
+
 	template<typename genType>
 	GLM_FUNC_QUALIFIER GLM_CONSTEXPR genType identity()
 	{
@@ -9,40 +70,13 @@ namespace glm
 	template<typename T, qualifier Q>
 	GLM_FUNC_QUALIFIER GLM_CONSTEXPR mat<4, 4, T, Q> translate(mat<4, 4, T, Q> const& m, vec<3, T, Q> const& v)
 	{
-		mat<4, 4, T, Q> Result(m);
-		Result[3] = m[0] * v[0] + m[1] * v[1] + m[2] * v[2] + m[3];
-		return Result;
+		return detail::compute_translate<T, Q, detail::is_aligned<Q>::value>::call(m, v);
 	}
 
 	template<typename T, qualifier Q>
 	GLM_FUNC_QUALIFIER mat<4, 4, T, Q> rotate(mat<4, 4, T, Q> const& m, T angle, vec<3, T, Q> const& v)
 	{
-		T const a = angle;
-		T const c = cos(a);
-		T const s = sin(a);
-
-		vec<3, T, Q> axis(normalize(v));
-		vec<3, T, Q> temp((T(1) - c) * axis);
-
-		mat<4, 4, T, Q> Rotate;
-		Rotate[0][0] = c + temp[0] * axis[0];
-		Rotate[0][1] = temp[0] * axis[1] + s * axis[2];
-		Rotate[0][2] = temp[0] * axis[2] - s * axis[1];
-
-		Rotate[1][0] = temp[1] * axis[0] - s * axis[2];
-		Rotate[1][1] = c + temp[1] * axis[1];
-		Rotate[1][2] = temp[1] * axis[2] + s * axis[0];
-
-		Rotate[2][0] = temp[2] * axis[0] + s * axis[1];
-		Rotate[2][1] = temp[2] * axis[1] - s * axis[0];
-		Rotate[2][2] = c + temp[2] * axis[2];
-
-		mat<4, 4, T, Q> Result;
-		Result[0] = m[0] * Rotate[0][0] + m[1] * Rotate[0][1] + m[2] * Rotate[0][2];
-		Result[1] = m[0] * Rotate[1][0] + m[1] * Rotate[1][1] + m[2] * Rotate[1][2];
-		Result[2] = m[0] * Rotate[2][0] + m[1] * Rotate[2][1] + m[2] * Rotate[2][2];
-		Result[3] = m[3];
-		return Result;
+		return detail::compute_rotate<T, Q, detail::is_aligned<Q>::value>::call(m, angle, v);
 	}
 
 	template<typename T, qualifier Q>
@@ -77,12 +111,7 @@ namespace glm
 	template<typename T, qualifier Q>
 	GLM_FUNC_QUALIFIER mat<4, 4, T, Q> scale(mat<4, 4, T, Q> const& m, vec<3, T, Q> const& v)
 	{
-		mat<4, 4, T, Q> Result;
-		Result[0] = m[0] * v[0];
-		Result[1] = m[1] * v[1];
-		Result[2] = m[2] * v[2];
-		Result[3] = m[3];
-		return Result;
+		return detail::compute_scale<T, Q, detail::is_aligned<Q>::value>::call(m, v);
 	}
 
 	template<typename T, qualifier Q>
@@ -205,3 +234,7 @@ namespace glm
 #       endif
 	}
 }//namespace glm
+
+#if GLM_CONFIG_SIMD == GLM_ENABLE
+#	include "matrix_transform_simd.inl"
+#endif
@@ -0,0 +1,47 @@
+/// @ref ext_matrix_transform
+
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+
+#include "../simd/matrix.h"
+
+namespace glm{
+namespace detail
+{
+#	if GLM_CONFIG_ALIGNED_GENTYPES == GLM_ENABLE
+	template<qualifier Q>
+	struct compute_translate<float, Q, true>
+	{
+		GLM_FUNC_QUALIFIER static mat<4, 4, float, Q> call(mat<4, 4, float, Q> const& m, vec<3, float, Q> const& v)
+		{
+			mat<4, 4, float, Q> Result;
+			glm_mat4_translate(&m[0].data, &v[0], &Result[0].data);
+			return Result;
+		}
+	};
+
+	template<qualifier Q>
+	struct compute_rotate<float, Q, true>
+	{
+		GLM_FUNC_QUALIFIER static mat<4, 4, float, Q> call(mat<4, 4, float, Q> const& m, float angle, vec<3, float, Q> const& v)
+		{
+			mat<4, 4, float, Q> Result;
+			glm_mat4_rotate(&m[0].data, cos(angle), sin(angle), &v[0], &Result[0].data);
+			return Result;
+		}
+	};
+
+	template<qualifier Q>
+	struct compute_scale<float, Q, true>
+	{
+		GLM_FUNC_QUALIFIER static mat<4, 4, float, Q> call(mat<4, 4, float, Q> const& m, vec<3, float, Q> const& v)
+		{
+			mat<4, 4, float, Q> Result;
+			glm_mat4_scale(&m[0].data, &v[0], &Result[0].data);
+			return Result;
+		}
+	};
+#	endif
+}//namespace detail
+}//namespace glm
+
+#endif//GLM_ARCH & GLM_ARCH_SSE2_BIT
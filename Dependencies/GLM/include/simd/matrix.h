@@ -4,9 +4,52 @@
 #pragma once
 
 #include "geometric.h"
+#include <cstddef>
 
 #if GLM_ARCH & GLM_ARCH_SSE2_BIT
 
+#if GLM_ARCH & GLM_ARCH_AVX2_BIT
+GLM_FUNC_QUALIFIER __m256 glm_vec8_fma(__m256 a, __m256 b, __m256 c)
+{
+#	if !(GLM_COMPILER & GLM_COMPILER_CLANG)
+		return _mm256_fmadd_ps(a, b, c);
+#	else
+		return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#	endif
+}
+
+// Two vec4 per register: both halves of v are multiplied by the matrix whose columns are repeated in both halves of m
+GLM_FUNC_QUALIFIER __m256 glm_mat4_mul_vec8(__m256 const m[4], __m256 v)
+{
+	__m256 const m0 = _mm256_mul_ps(m[0], _mm256_permute_ps(v, _MM_SHUFFLE(0, 0, 0, 0)));
+	__m256 const m2 = _mm256_mul_ps(m[2], _mm256_permute_ps(v, _MM_SHUFFLE(2, 2, 2, 2)));
+	__m256 const a0 = glm_vec8_fma(m[1], _mm256_permute_ps(v, _MM_SHUFFLE(1, 1, 1, 1)), m0);
+	__m256 const a1 = glm_vec8_fma(m[3], _mm256_permute_ps(v, _MM_SHUFFLE(3, 3, 3, 3)), m2);
+	return _mm256_add_ps(a0, a1);
+}
+
+GLM_FUNC_QUALIFIER void glm_mat4_broadcast_avx(glm_vec4 const in[4], __m256 out[4])
+{
+	out[0] = _mm256_broadcast_ps(&in[0]);
+	out[1] = _mm256_broadcast_ps(&in[1]);
+	out[2] = _mm256_broadcast_ps(&in[2]);
+	out[3] = _mm256_broadcast_ps(&in[3]);
+}
+
+// Two columns of the result per multiplication. in1, in2 and out may alias
+GLM_FUNC_QUALIFIER void glm_mat4_mul_avx2(glm_vec4 const in1[4], glm_vec4 const in2[4], glm_vec4 out[4])
+{
+	__m256 m[4];
+	glm_mat4_broadcast_avx(in1, m);
+
+	__m256 const c01 = glm_mat4_mul_vec8(m, _mm256_loadu_ps(reinterpret_cast<float const*>(&in2[0])));
+	__m256 const c23 = glm_mat4_mul_vec8(m, _mm256_loadu_ps(reinterpret_cast<float const*>(&in2[2])));
+
+	_mm256_storeu_ps(reinterpret_cast<float*>(&out[0]), c01);
+	_mm256_storeu_ps(reinterpret_cast<float*>(&out[2]), c23);
+}
+#endif//GLM_ARCH & GLM_ARCH_AVX2_BIT
+
 GLM_FUNC_QUALIFIER void glm_mat4_matrixCompMult(glm_vec4 const in1[4], glm_vec4 const in2[4], glm_vec4 out[4])
 {
 	out[0] = _mm_mul_ps(in1[0], in2[0]);
@@ -33,6 +76,13 @@ GLM_FUNC_QUALIFIER void glm_mat4_sub(glm_vec4 const in1[4], glm_vec4 const in2[4
 
 GLM_FUNC_QUALIFIER glm_vec4 glm_mat4_mul_vec4(glm_vec4 const m[4], glm_vec4 v)
 {
+#	if GLM_ARCH & GLM_ARCH_AVX2_BIT
+		__m128 const m0 = _mm_mul_ps(m[0], _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+		__m128 const m2 = _mm_mul_ps(m[2], _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2)));
+		__m128 const a0 = glm_vec4_fma(m[1], _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)), m0);
+		__m128 const a1 = glm_vec4_fma(m[3], _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)), m2);
+		return _mm_add_ps(a0, a1);
+#	else
 	__m128 v0 = _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0));
 	__m128 v1 = _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1));
 	__m128 v2 = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2));
@@ -48,6 +98,7 @@ GLM_FUNC_QUALIFIER glm_vec4 glm_mat4_mul_vec4(glm_vec4 const m[4], glm_vec4 v)
 	__m128 a2 = _mm_add_ps(a0, a1);
 
 	return a2;
+#	endif
 }
 
 GLM_FUNC_QUALIFIER __m128 glm_vec4_mul_mat4(glm_vec4 v, glm_vec4 const m[4])
@@ -79,6 +130,10 @@ GLM_FUNC_QUALIFIER __m128 glm_vec4_mul_mat4(glm_vec4 v, glm_vec4 const m[4])
 
 GLM_FUNC_QUALIFIER void glm_mat4_mul(glm_vec4 const in1[4], glm_vec4 const in2[4], glm_vec4 out[4])
 {
+#	if GLM_ARCH & GLM_ARCH_AVX2_BIT
+		glm_mat4_mul_avx2(in1, in2, out);
+#	else
+
 	{
 		__m128 e0 = _mm_shuffle_ps(in2[0], in2[0], _MM_SHUFFLE(0, 0, 0, 0));
 		__m128 e1 = _mm_shuffle_ps(in2[0], in2[0], _MM_SHUFFLE(1, 1, 1, 1));
@@ -151,6 +206,7 @@ GLM_FUNC_QUALIFIER void glm_mat4_mul(glm_vec4 const in1[4], glm_vec4 const in2[4
 
 		out[3] = a2;
 	}
+#	endif
 }
 
 GLM_FUNC_QUALIFIER void glm_mat4_transpose(glm_vec4 const in[4], glm_vec4 out[4])
@@ -946,77 +1002,78 @@ GLM_FUNC_QUALIFIER void glm_mat4_inverse_lowp(glm_vec4 const in[4], glm_vec4 out
 	out[2] = _mm_mul_ps(Inv2, Rcp0);
 	out[3] = _mm_mul_ps(Inv3, Rcp0);
 }
-/*
-GLM_FUNC_QUALIFIER void glm_mat4_rotate(__m128 const in[4], float Angle, float const v[3], __m128 out[4])
+GLM_FUNC_QUALIFIER void glm_mat4_translate(glm_vec4 const in[4], float const v[3], glm_vec4 out[4])
+{
+	// Result[3] = m[0] * v[0] + m[1] * v[1] + m[2] * v[2] + m[3];
+	glm_vec4 const Mul0 = _mm_mul_ps(in[0], _mm_set1_ps(v[0]));
+	glm_vec4 const Fma1 = glm_vec4_fma(in[1], _mm_set1_ps(v[1]), Mul0);
+	glm_vec4 const Fma2 = glm_vec4_fma(in[2], _mm_set1_ps(v[2]), Fma1);
+
+	out[0] = in[0];
+	out[1] = in[1];
+	out[2] = in[2];
+	out[3] = _mm_add_ps(Fma2, in[3]);
+}
+
+GLM_FUNC_QUALIFIER void glm_mat4_scale(glm_vec4 const in[4], float const v[3], glm_vec4 out[4])
 {
-	float a = glm::radians(Angle);
-	float c = cos(a);
-	float s = sin(a);
+	out[0] = _mm_mul_ps(in[0], _mm_set1_ps(v[0]));
+	out[1] = _mm_mul_ps(in[1], _mm_set1_ps(v[1]));
+	out[2] = _mm_mul_ps(in[2], _mm_set1_ps(v[2]));
+	out[3] = in[3];
+}
 
-	glm::vec4 AxisA(v[0], v[1], v[2], float(0));
-	__m128 AxisB = _mm_set_ps(AxisA.w, AxisA.z, AxisA.y, AxisA.x);
-	__m128 AxisC = detail::sse_nrm_ps(AxisB);
+// Angle in radians, like glm::rotate. The cosine and sine are computed by the caller.
+GLM_FUNC_QUALIFIER void glm_mat4_rotate(glm_vec4 const in[4], float c, float s, float const v[3], glm_vec4 out[4])
+{
+	// vec<3, T, Q> axis(normalize(v));
+	glm_vec4 const AxisA = _mm_set_ps(0.0f, v[2], v[1], v[0]);
+	glm_vec4 const AxisC = _mm_div_ps(AxisA, _mm_sqrt_ps(glm_vec4_dot(AxisA, AxisA)));
 
-	__m128 Cos0 = _mm_set_ss(c);
-	__m128 CosA = _mm_shuffle_ps(Cos0, Cos0, _MM_SHUFFLE(0, 0, 0, 0));
-	__m128 Sin0 = _mm_set_ss(s);
-	__m128 SinA = _mm_shuffle_ps(Sin0, Sin0, _MM_SHUFFLE(0, 0, 0, 0));
+	// vec<3, T, Q> temp((T(1) - c) * axis);
+	glm_vec4 const Temp0 = _mm_mul_ps(_mm_set1_ps(1.0f - c), AxisC);
+	glm_vec4 const SinA = _mm_mul_ps(_mm_set1_ps(s), AxisC);
 
-	// vec<3, T, Q> temp = (valType(1) - c) * axis;
-	__m128 Temp0 = _mm_sub_ps(one, CosA);
-	__m128 Temp1 = _mm_mul_ps(Temp0, AxisC);
+	glm_vec4 const Cos0 = _mm_set_ss(c);
+	glm_vec4 const SignX = _mm_castsi128_ps(_mm_set_epi32(0, 0, 0, int(0x80000000)));
+	glm_vec4 const SignY = _mm_castsi128_ps(_mm_set_epi32(0, 0, int(0x80000000), 0));
+	glm_vec4 const SignZ = _mm_castsi128_ps(_mm_set_epi32(0, int(0x80000000), 0, 0));
 
 	//Rotate[0][0] = c + temp[0] * axis[0];
-	//Rotate[0][1] = 0 + temp[0] * axis[1] + s * axis[2];
-	//Rotate[0][2] = 0 + temp[0] * axis[2] - s * axis[1];
-	__m128 Axis0 = _mm_shuffle_ps(AxisC, AxisC, _MM_SHUFFLE(0, 0, 0, 0));
-	__m128 TmpA0 = _mm_mul_ps(Axis0, AxisC);
-	__m128 CosA0 = _mm_shuffle_ps(Cos0, Cos0, _MM_SHUFFLE(1, 1, 1, 0));
-	__m128 TmpA1 = _mm_add_ps(CosA0, TmpA0);
-	__m128 SinA0 = SinA;//_mm_set_ps(0.0f, s, -s, 0.0f);
-	__m128 TmpA2 = _mm_shuffle_ps(AxisC, AxisC, _MM_SHUFFLE(3, 1, 2, 3));
-	__m128 TmpA3 = _mm_mul_ps(SinA0, TmpA2);
-	__m128 TmpA4 = _mm_add_ps(TmpA1, TmpA3);
-
-	//Rotate[1][0] = 0 + temp[1] * axis[0] - s * axis[2];
+	//Rotate[0][1] = temp[0] * axis[1] + s * axis[2];
+	//Rotate[0][2] = temp[0] * axis[2] - s * axis[1];
+	glm_vec4 const SinA0 = _mm_xor_ps(_mm_shuffle_ps(SinA, SinA, _MM_SHUFFLE(3, 1, 2, 3)), SignZ);
+	glm_vec4 const TmpA0 = _mm_add_ps(Cos0, SinA0);
+	glm_vec4 const Rotate0 = glm_vec4_fma(_mm_shuffle_ps(Temp0, Temp0, _MM_SHUFFLE(0, 0, 0, 0)), AxisC, TmpA0);
+
+	//Rotate[1][0] = temp[1] * axis[0] - s * axis[2];
 	//Rotate[1][1] = c + temp[1] * axis[1];
-	//Rotate[1][2] = 0 + temp[1] * axis[2] + s * axis[0];
-	__m128 Axis1 = _mm_shuffle_ps(AxisC, AxisC, _MM_SHUFFLE(1, 1, 1, 1));
-	__m128 TmpB0 = _mm_mul_ps(Axis1, AxisC);
-	__m128 CosA1 = _mm_shuffle_ps(Cos0, Cos0, _MM_SHUFFLE(1, 1, 0, 1));
-	__m128 TmpB1 = _mm_add_ps(CosA1, TmpB0);
-	__m128 SinB0 = SinA;//_mm_set_ps(-s, 0.0f, s, 0.0f);
-	__m128 TmpB2 = _mm_shuffle_ps(AxisC, AxisC, _MM_SHUFFLE(3, 0, 3, 2));
-	__m128 TmpB3 = _mm_mul_ps(SinA0, TmpB2);
-	__m128 TmpB4 = _mm_add_ps(TmpB1, TmpB3);
-
-	//Rotate[2][0] = 0 + temp[2] * axis[0] + s * axis[1];
-	//Rotate[2][1] = 0 + temp[2] * axis[1] - s * axis[0];
+	//Rotate[1][2] = temp[1] * axis[2] + s * axis[0];
+	glm_vec4 const SinB0 = _mm_xor_ps(_mm_shuffle_ps(SinA, SinA, _MM_SHUFFLE(3, 0, 3, 2)), SignX);
+	glm_vec4 const TmpB0 = _mm_add_ps(_mm_shuffle_ps(Cos0, Cos0, _MM_SHUFFLE(1, 1, 0, 1)), SinB0);
+	glm_vec4 const Rotate1 = glm_vec4_fma(_mm_shuffle_ps(Temp0, Temp0, _MM_SHUFFLE(1, 1, 1, 1)), AxisC, TmpB0);
+
+	//Rotate[2][0] = temp[2] * axis[0] + s * axis[1];
+	//Rotate[2][1] = temp[2] * axis[1] - s * axis[0];
 	//Rotate[2][2] = c + temp[2] * axis[2];
-	__m128 Axis2 = _mm_shuffle_ps(AxisC, AxisC, _MM_SHUFFLE(2, 2, 2, 2));
-	__m128 TmpC0 = _mm_mul_ps(Axis2, AxisC);
-	__m128 CosA2 = _mm_shuffle_ps(Cos0, Cos0, _MM_SHUFFLE(1, 0, 1, 1));
-	__m128 TmpC1 = _mm_add_ps(CosA2, TmpC0);
-	__m128 SinC0 = SinA;//_mm_set_ps(s, -s, 0.0f, 0.0f);
-	__m128 TmpC2 = _mm_shuffle_ps(AxisC, AxisC, _MM_SHUFFLE(3, 3, 0, 1));
-	__m128 TmpC3 = _mm_mul_ps(SinA0, TmpC2);
-	__m128 TmpC4 = _mm_add_ps(TmpC1, TmpC3);
-
-	__m128 Result[4];
-	Result[0] = TmpA4;
-	Result[1] = TmpB4;
-	Result[2] = TmpC4;
-	Result[3] = _mm_set_ps(1, 0, 0, 0);
-
-	//mat<4, 4, valType> Result;
+	glm_vec4 const SinC0 = _mm_xor_ps(_mm_shuffle_ps(SinA, SinA, _MM_SHUFFLE(3, 3, 0, 1)), SignY);
+	glm_vec4 const TmpC0 = _mm_add_ps(_mm_shuffle_ps(Cos0, Cos0, _MM_SHUFFLE(1, 0, 1, 1)), SinC0);
+	glm_vec4 const Rotate2 = glm_vec4_fma(_mm_shuffle_ps(Temp0, Temp0, _MM_SHUFFLE(2, 2, 2, 2)), AxisC, TmpC0);
+
 	//Result[0] = m[0] * Rotate[0][0] + m[1] * Rotate[0][1] + m[2] * Rotate[0][2];
 	//Result[1] = m[0] * Rotate[1][0] + m[1] * Rotate[1][1] + m[2] * Rotate[1][2];
 	//Result[2] = m[0] * Rotate[2][0] + m[1] * Rotate[2][1] + m[2] * Rotate[2][2];
 	//Result[3] = m[3];
-	//return Result;
-	sse_mul_ps(in, Result, out);
+	glm_vec4 const Rotate[3] = {Rotate0, Rotate1, Rotate2};
+	for(int i = 0; i < 3; ++i)
+	{
+		glm_vec4 const Mul0 = _mm_mul_ps(in[0], _mm_shuffle_ps(Rotate[i], Rotate[i], _MM_SHUFFLE(0, 0, 0, 0)));
+		glm_vec4 const Fma1 = glm_vec4_fma(in[1], _mm_shuffle_ps(Rotate[i], Rotate[i], _MM_SHUFFLE(1, 1, 1, 1)), Mul0);
+		out[i] = glm_vec4_fma(in[2], _mm_shuffle_ps(Rotate[i], Rotate[i], _MM_SHUFFLE(2, 2, 2, 2)), Fma1);
+	}
+	out[3] = in[3];
 }
-*/
+
 GLM_FUNC_QUALIFIER void glm_mat4_outerProduct(__m128 const& c, __m128 const& r, __m128 out[4])
 {
 	out[0] = _mm_mul_ps(c, _mm_shuffle_ps(r, r, _MM_SHUFFLE(0, 0, 0, 0)));
@@ -1025,4 +1082,52 @@ GLM_FUNC_QUALIFIER void glm_mat4_outerProduct(__m128 const& c, __m128 const& r,
 	out[3] = _mm_mul_ps(c, _mm_shuffle_ps(r, r, _MM_SHUFFLE(3, 3, 3, 3)));
 }
 
+// out[i] = m * in[i] for count vectors (arrays of glm::aligned_vec4, 16 bytes aligned).
+// Non-temporal stores: meant for large arrays that are not read again right away. in and out must not overlap
+GLM_FUNC_QUALIFIER void glm_mat4_mul_vec4_batch(glm_vec4 const m[4], glm_vec4 const* in, glm_vec4* out, std::size_t count)
+{
+	std::size_t i = 0;
+
+#	if GLM_ARCH & GLM_ARCH_AVX2_BIT
+		__m256 M[4];
+		glm_mat4_broadcast_avx(m, M);
+
+		for(; i + 2 <= count; i += 2)
+		{
+			__m256 const v = glm_mat4_mul_vec8(M, _mm256_loadu_ps(reinterpret_cast<float const*>(&in[i])));
+			_mm_stream_ps(reinterpret_cast<float*>(&out[i + 0]), _mm256_castps256_ps128(v));
+			_mm_stream_ps(reinterpret_cast<float*>(&out[i + 1]), _mm256_extractf128_ps(v, 1));
+		}
+#	endif
+
+	for(; i < count; ++i)
+		_mm_stream_ps(reinterpret_cast<float*>(&out[i]), glm_mat4_mul_vec4(m, _mm_load_ps(reinterpret_cast<float const*>(&in[i]))));
+
+	_mm_sfence();
+}
+
+#if GLM_ARCH & GLM_ARCH_AVX2_BIT
+// out[i] = in1[i] * in2[i] for count matrices stored as 4 consecutive columns (arrays of glm::aligned_mat4).
+// Only in AVX2 builds: with SSE alone there is nothing to gain over a loop of glm_mat4_mul.
+// Non-temporal stores: meant for large arrays that are not read again right away. out must not overlap the inputs
+GLM_FUNC_QUALIFIER void glm_mat4_mul_batch(glm_vec4 const* in1, glm_vec4 const* in2, glm_vec4* out, std::size_t count)
+{
+	for(std::size_t i = 0; i < count; ++i, in1 += 4, in2 += 4, out += 4)
+	{
+		__m256 m[4];
+		glm_mat4_broadcast_avx(in1, m);
+
+		__m256 const c01 = glm_mat4_mul_vec8(m, _mm256_loadu_ps(reinterpret_cast<float const*>(&in2[0])));
+		__m256 const c23 = glm_mat4_mul_vec8(m, _mm256_loadu_ps(reinterpret_cast<float const*>(&in2[2])));
+
+		_mm_stream_ps(reinterpret_cast<float*>(&out[0]), _mm256_castps256_ps128(c01));
+		_mm_stream_ps(reinterpret_cast<float*>(&out[1]), _mm256_extractf128_ps(c01, 1));
+		_mm_stream_ps(reinterpret_cast<float*>(&out[2]), _mm256_castps256_ps128(c23));
+		_mm_stream_ps(reinterpret_cast<float*>(&out[3]), _mm256_extractf128_ps(c23, 1));
+	}
+
+	_mm_sfence();
+}
+#endif//GLM_ARCH & GLM_ARCH_AVX2_BIT
+
 #endif//GLM_ARCH & GLM_ARCH_SSE2_BIT
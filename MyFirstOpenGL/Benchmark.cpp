@@ -0,0 +1,982 @@
+#include "Benchmark.h"
+#include "File.h"
+#include "GameObjects.h"
+#include "JobSystem.h"
+#include "ModelMatrix.h"
+#include "Mesh.h"
+#include "MeshFile.h"
+#include "ModelImporter.h"
+#include "Camera.h"
+#include "Culling.h"
+#include "Bvh.h"
+#include "RenderQueue.h"
+#include <gtc/matrix_transform.hpp>
+#if GLM_CONFIG_ALIGNED_GENTYPES == GLM_ENABLE
+#include <gtc/type_aligned.hpp>
+#endif
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <cstring>
+
+//Numero de archivos GLSL generados y lineas de cada uno (~4 MB por archivo)
+#define BENCHMARK_FILE_COUNT 8
+#define BENCHMARK_FILE_LINES 65536
+#define BENCHMARK_REPETITIONS 5
+
+//Diferencia maxima admitida entre dos formas de calcular las mismas matrices o vectores (orden de operaciones y FMA)
+#define BENCHMARK_EPSILON 1e-3f
+
+//Diferencia maxima entre glm::rotate/translate/scale escalar y los kernels SSE: es el mismo calculo, solo cambia el redondeo
+#define BENCHMARK_TRANSFORM_EPSILON 1e-5f
+
+//Objetos simulados y pasos medidos en el benchmark de GameObjects
+#define BENCHMARK_OBJECT_COUNT 1000000
+#define BENCHMARK_SIMULATION_STEPS 20
+
+//Lado en quads de la rejilla del benchmark de mallas indexadas y del de archivos .mesh
+#define BENCHMARK_GRID_SIZE 256
+#define BENCHMARK_MESH_FILE_GRID_SIZE 1024
+#define BENCHMARK_IMPORT_GRID_SIZE 512
+
+//Diferencia maxima entre las posiciones importadas del OBJ (texto) y del GLB (floats binarios)
+#define BENCHMARK_IMPORT_EPSILON 1e-5f
+
+//Objetos repartidos en [-4, 4] para el culling: la camara por defecto ve [-1, 1], mas o menos 1/16
+#define BENCHMARK_CULL_OBJECTS 100000
+#define BENCHMARK_CULL_EXTENT 4.f
+
+//Rayos de seleccion lanzados contra el BVH y contra todas las cajas
+#define BENCHMARK_RAY_COUNT 1000
+
+//Draws de la cola de render: 8 programas, 16 VAO y 32 materiales con profundidades al azar
+#define BENCHMARK_QUEUE_COMMANDS 100000
+
+
+//Implementacion anterior de Load_File, linea a linea, como referencia
+std::string LoadFileByLines(const std::string& filePath) {
+
+	std::ifstream file(filePath);
+
+	std::string fileContent;
+	std::string line;
+
+	while (std::getline(file, line)) {
+		fileContent += line + "\n";
+	}
+
+	return fileContent;
+}
+
+
+//Recorre todo el contenido, como haria el compilador de shaders
+size_t ConsumeContent(std::string_view content) {
+
+	size_t sum = 0;
+	for (char character : content)
+		sum += static_cast<unsigned char>(character);
+
+	return sum;
+}
+
+
+double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+bool RunFileLoadBenchmark() {
+
+	//Generamos archivos GLSL grandes en la carpeta temporal
+	std::filesystem::path directory = std::filesystem::temp_directory_path() / "MyFirstOpenGLBenchmark";
+	std::filesystem::create_directories(directory);
+
+	std::vector<std::string> filePaths;
+	size_t totalBytes = 0;
+	for (int i = 0; i < BENCHMARK_FILE_COUNT; i++) {
+		std::string filePath = (directory / ("shader" + std::to_string(i) + ".glsl")).string();
+		std::ofstream file(filePath, std::ios::binary);
+
+		file << "#version 440 core\n\nuniform float time;\nout vec4 fragColor;\n\nvoid main()\n{\n\tvec4 color = vec4(0.0);\n";
+		for (int line = 0; line < BENCHMARK_FILE_LINES; line++)
+			file << "\tcolor += vec4(sin(time * " << line << ".0), cos(time), 0.5, 1.0) * 0.0001;\n";
+		file << "\tfragColor = color;\n}\n";
+
+		totalBytes += static_cast<size_t>(file.tellp());
+		filePaths.push_back(filePath);
+	}
+
+	//Acumulamos el contenido leido para que el compilador no elimine el trabajo. Las tres formas de leer
+	//tienen que dar la misma suma
+	size_t checksums[3] = {};
+	double byLinesMilliseconds = 0.0;
+	double singleReadMilliseconds = 0.0;
+	double mappedMilliseconds = 0.0;
+
+	for (int repetition = 0; repetition < BENCHMARK_REPETITIONS; repetition++) {
+
+		auto start = std::chrono::steady_clock::now();
+		for (const std::string& filePath : filePaths)
+			checksums[0] += ConsumeContent(LoadFileByLines(filePath));
+		byLinesMilliseconds += MillisecondsSince(start);
+
+		start = std::chrono::steady_clock::now();
+		for (const std::string& filePath : filePaths) {
+			std::string content;
+			Load_File(filePath, content);
+			checksums[1] += ConsumeContent(content);
+		}
+		singleReadMilliseconds += MillisecondsSince(start);
+
+		start = std::chrono::steady_clock::now();
+		for (const std::string& filePath : filePaths) {
+			FileView view;
+			MapFile(filePath, view);
+			checksums[2] += ConsumeContent(ViewOf(view));
+			UnmapFile(view);
+		}
+		mappedMilliseconds += MillisecondsSince(start);
+	}
+
+	bool match = checksums[0] != 0 && checksums[0] == checksums[1] && checksums[0] == checksums[2];
+	double megabytes = static_cast<double>(totalBytes) * BENCHMARK_REPETITIONS / (1024.0 * 1024.0);
+	std::cout << "Carga de archivos (" << BENCHMARK_FILE_COUNT << " x " << totalBytes / BENCHMARK_FILE_COUNT / 1024 << " KB, "
+		<< BENCHMARK_REPETITIONS << " repeticiones, checksum " << checksums[0] << (match ? ")" : ", RESULTADOS DISTINTOS)") << std::endl;
+	std::cout << "  getline linea a linea: " << byLinesMilliseconds << " ms (" << megabytes / (byLinesMilliseconds / 1000.0) << " MB/s)" << std::endl;
+	std::cout << "  lectura unica:         " << singleReadMilliseconds << " ms (" << megabytes / (singleReadMilliseconds / 1000.0) << " MB/s), x"
+		<< byLinesMilliseconds / singleReadMilliseconds << std::endl;
+	std::cout << "  mapeo en memoria:      " << mappedMilliseconds << " ms (" << megabytes / (mappedMilliseconds / 1000.0) << " MB/s), x"
+		<< byLinesMilliseconds / mappedMilliseconds << std::endl;
+
+	std::error_code error;
+	std::filesystem::remove_all(directory, error);
+	return match;
+}
+
+
+//Paso de simulacion anterior: un GameObject (AoS) cada vez con glm::vec3
+void SimulateGameObjectsAoS(std::vector<GameObject>& objects) {
+
+	for (GameObject& object : objects) {
+		object.position += object.forward * object.velocity;
+		object.rotation += object.forwardRotation * object.angularVelocity;
+
+		if (object.position.y >= 0.9f || object.position.y <= -0.9f)
+			object.forward = -object.forward;
+	}
+}
+
+
+bool RunGameObjectBenchmark() {
+
+	//Mismos objetos en los tres formatos
+	std::vector<GameObject> aos(BENCHMARK_OBJECT_COUNT);
+	GameObjectArray soaScalar = CreateGameObjectArray(MOVE_POSITION, -0.9f, 0.9f, BENCHMARK_OBJECT_COUNT);
+	for (size_t i = 0; i < aos.size(); i++) {
+		GameObject& object = aos[i];
+		object.position = glm::vec3(0.f, -0.9f + 1.8f * static_cast<float>(i % 1000) / 1000.f, 0.f);
+		object.forward = glm::vec3(0.f, (i % 2 == 0) ? 1.f : -1.f, 0.f);
+		object.forwardRotation = glm::vec3(0.f, 1.f, 0.f);
+		object.velocity = 0.01f;
+		AddGameObject(soaScalar, object);
+	}
+	GameObjectArray soaSimd = soaScalar;
+
+	auto start = std::chrono::steady_clock::now();
+	for (int step = 0; step < BENCHMARK_SIMULATION_STEPS; step++)
+		SimulateGameObjectsAoS(aos);
+	double aosMilliseconds = MillisecondsSince(start) / BENCHMARK_SIMULATION_STEPS;
+
+	start = std::chrono::steady_clock::now();
+	for (int step = 0; step < BENCHMARK_SIMULATION_STEPS; step++)
+		SimulateGameObjectsScalar(soaScalar);
+	double scalarMilliseconds = MillisecondsSince(start) / BENCHMARK_SIMULATION_STEPS;
+
+	start = std::chrono::steady_clock::now();
+	for (int step = 0; step < BENCHMARK_SIMULATION_STEPS; step++)
+		SimulateGameObjects(soaSimd);
+	double simdMilliseconds = MillisecondsSince(start) / BENCHMARK_SIMULATION_STEPS;
+
+	//Las tres versiones tienen que acabar en el mismo estado
+	size_t mismatches = 0;
+	for (size_t i = 0; i < aos.size(); i++) {
+		if (aos[i].position.y != soaScalar.positionY[i] || soaScalar.positionY[i] != soaSimd.positionY[i] ||
+			soaScalar.forwardY[i] != soaSimd.forwardY[i] || soaScalar.rotationY[i] != soaSimd.rotationY[i])
+			mismatches++;
+	}
+
+	std::cout << "Simulacion de GameObjects (" << BENCHMARK_OBJECT_COUNT << " objetos, ms por paso, " << mismatches << " diferencias)" << std::endl;
+	std::cout << "  AoS glm::vec3:   " << aosMilliseconds << " ms" << std::endl;
+	std::cout << "  SoA escalar:     " << scalarMilliseconds << " ms, x" << aosMilliseconds / scalarMilliseconds << std::endl;
+	std::cout << "  SoA SSE/AVX:     " << simdMilliseconds << " ms, x" << aosMilliseconds / simdMilliseconds << std::endl;
+	return mismatches == 0;
+}
+
+
+bool RunJobSystemBenchmark() {
+
+	GameObjectArray objects = CreateGameObjectArray(MOVE_POSITION, -0.9f, 0.9f, BENCHMARK_OBJECT_COUNT);
+	for (size_t i = 0; i < BENCHMARK_OBJECT_COUNT; i++) {
+		GameObject object;
+		object.position = glm::vec3(0.f, -0.9f + 1.8f * static_cast<float>(i % 1000) / 1000.f, 0.f);
+		object.forward = glm::vec3(0.f, 1.f, 0.f);
+		object.forwardRotation = glm::vec3(0.f, 1.f, 0.f);
+		AddGameObject(objects, object);
+	}
+	std::vector<glm::mat4> matrices(BENCHMARK_OBJECT_COUNT);
+
+	//Probamos con 0 workers (solo el hilo principal) y doblando hasta usar todos los nucleos
+	std::vector<size_t> workerCounts = { 0 };
+	for (size_t workers = 1; workers < DefaultWorkerCount(); workers = workers * 2 + 1)
+		workerCounts.push_back(workers);
+	if (DefaultWorkerCount() > 0)
+		workerCounts.push_back(DefaultWorkerCount());
+
+	std::cout << "Simulacion y matrices en paralelo (" << BENCHMARK_OBJECT_COUNT << " objetos, ms por paso)" << std::endl;
+
+	//Cada pasada empieza del mismo estado; con cualquier numero de hilos las matrices tienen que salir iguales
+	GameObjectArray initialObjects = objects;
+	std::vector<glm::mat4> singleThreadMatrices;
+	size_t mismatches = 0;
+
+	double singleThreadMilliseconds = 0.0;
+	for (size_t workers : workerCounts) {
+
+		JobSystem jobSystem;
+		CreateJobSystem(jobSystem, workers);
+		objects = initialObjects;
+
+		auto start = std::chrono::steady_clock::now();
+		for (int step = 0; step < BENCHMARK_SIMULATION_STEPS; step++) {
+			ParallelFor(jobSystem, objects.count, 16384, [&objects](size_t begin, size_t end) {
+				SimulateGameObjectRange(objects, begin, end);
+			});
+			ParallelFor(jobSystem, objects.count, 1024, [&objects, &matrices](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++) {
+					GameObject object = GetGameObject(objects, i);
+					matrices[i] = glm::translate(glm::mat4(1.f), object.position) *
+						glm::rotate(glm::mat4(1.f), object.rotation.y, glm::vec3(0.f, 1.f, 0.f)) *
+						glm::scale(glm::mat4(1.f), object.scale);
+				}
+			});
+		}
+		double milliseconds = MillisecondsSince(start) / BENCHMARK_SIMULATION_STEPS;
+		if (workers == 0) {
+			singleThreadMilliseconds = milliseconds;
+			singleThreadMatrices = matrices;
+		}
+		else {
+			for (size_t i = 0; i < matrices.size(); i++)
+				mismatches += matrices[i] != singleThreadMatrices[i] ? 1 : 0;
+		}
+
+		std::cout << "  " << workers + 1 << " hilos: " << milliseconds << " ms, x" << singleThreadMilliseconds / milliseconds
+			<< " (" << jobSystem.jobsExecuted << " trabajos, " << jobSystem.jobsStolen << " robados)" << std::endl;
+
+		DestroyJobSystem(jobSystem);
+	}
+
+	if (mismatches != 0)
+		std::cout << "  " << mismatches << " matrices distintas de las de un hilo (RESULTADOS DISTINTOS)" << std::endl;
+	return mismatches == 0;
+}
+
+
+//Camino anterior: tres matrices 4x4 completas y dos multiplicaciones generales
+glm::mat4 ThreeMatrixModel(const glm::vec3& position, const glm::vec3& axis, float degrees, const glm::vec3& scale) {
+
+	glm::mat4 rotation = glm::rotate(glm::mat4(1.f), glm::radians(degrees), glm::normalize(axis));
+	return rotation * glm::translate(glm::mat4(1.f), position) * glm::scale(glm::mat4(1.f), scale);
+}
+
+
+float MaxDifference(const glm::mat4& a, const glm::mat4& b) {
+
+	float difference = 0.f;
+	for (int column = 0; column < 4; column++)
+		for (int row = 0; row < 4; row++)
+			difference = std::max(difference, std::abs(a[column][row] - b[column][row]));
+	return difference;
+}
+
+
+bool RunModelMatrixBenchmark() {
+
+	//Entradas variadas, precalculadas para medir solo la composicion
+	std::vector<glm::vec3> positions(BENCHMARK_OBJECT_COUNT), rotations(BENCHMARK_OBJECT_COUNT), scales(BENCHMARK_OBJECT_COUNT);
+	for (size_t i = 0; i < BENCHMARK_OBJECT_COUNT; i++) {
+		float t = static_cast<float>(i) * 0.001f;
+		positions[i] = glm::vec3(std::sin(t), std::cos(t * 0.7f), std::sin(t * 0.3f));
+		rotations[i] = glm::vec3(t * 3.f, -t * 5.f - 1.f, t * 7.f);
+		scales[i] = glm::vec3(0.5f + std::abs(std::sin(t)), 1.f, 1.5f);
+	}
+	std::vector<glm::mat4> threeMatrix(BENCHMARK_OBJECT_COUNT), composed(BENCHMARK_OBJECT_COUNT);
+
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < BENCHMARK_OBJECT_COUNT; i++)
+		threeMatrix[i] = ThreeMatrixModel(positions[i], rotations[i], rotations[i].y, scales[i]);
+	double threeMatrixMilliseconds = MillisecondsSince(start);
+
+	start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < BENCHMARK_OBJECT_COUNT; i++)
+		composed[i] = ComposeModelMatrix(positions[i], rotations[i], rotations[i].y, scales[i]);
+	double composedMilliseconds = MillisecondsSince(start);
+
+	float axisAngleDifference = 0.f;
+	for (size_t i = 0; i < BENCHMARK_OBJECT_COUNT; i++)
+		axisAngleDifference = std::max(axisAngleDifference, MaxDifference(threeMatrix[i], composed[i]));
+
+	//Euler X e Y como la piramide: Rx * Ry * T * S
+	start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < BENCHMARK_OBJECT_COUNT; i++) {
+		glm::mat4 rotationX = glm::rotate(glm::mat4(1.f), glm::radians(rotations[i].x), glm::vec3(1.f, 0.f, 0.f));
+		glm::mat4 rotationY = glm::rotate(glm::mat4(1.f), glm::radians(rotations[i].y), glm::vec3(0.f, 1.f, 0.f));
+		threeMatrix[i] = rotationX * rotationY * glm::translate(glm::mat4(1.f), positions[i]) * glm::scale(glm::mat4(1.f), scales[i]);
+	}
+	double eulerThreeMatrixMilliseconds = MillisecondsSince(start);
+
+	start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < BENCHMARK_OBJECT_COUNT; i++)
+		composed[i] = ComposeModelMatrix(positions[i], EulerRotation(glm::vec3(rotations[i].x, rotations[i].y, 0.f)), scales[i]);
+	double eulerComposedMilliseconds = MillisecondsSince(start);
+
+	float eulerDifference = 0.f;
+	for (size_t i = 0; i < BENCHMARK_OBJECT_COUNT; i++)
+		eulerDifference = std::max(eulerDifference, MaxDifference(threeMatrix[i], composed[i]));
+
+	double nanoseconds = 1000000.0 / BENCHMARK_OBJECT_COUNT;
+	std::cout << "Matriz de modelo (" << BENCHMARK_OBJECT_COUNT << " matrices, ns por matriz)" << std::endl;
+	std::cout << "  eje-angulo, 3 matrices:  " << threeMatrixMilliseconds * nanoseconds << " ns" << std::endl;
+	std::cout << "  eje-angulo, directa:     " << composedMilliseconds * nanoseconds << " ns, x"
+		<< threeMatrixMilliseconds / composedMilliseconds << " (diferencia maxima " << axisAngleDifference << ")" << std::endl;
+	std::cout << "  euler XY, 4 matrices:    " << eulerThreeMatrixMilliseconds * nanoseconds << " ns" << std::endl;
+	std::cout << "  euler XY, directa:       " << eulerComposedMilliseconds * nanoseconds << " ns, x"
+		<< eulerThreeMatrixMilliseconds / eulerComposedMilliseconds << " (diferencia maxima " << eulerDifference << ")" << std::endl;
+	return axisAngleDifference <= BENCHMARK_EPSILON && eulerDifference <= BENCHMARK_EPSILON;
+}
+
+
+//glm::rotate, translate y scale sobre glm::mat4 (empaquetada, escalar) y sobre glm::aligned_mat4, que con
+//GLM_FORCE_INTRINSICS pasa por los kernels SSE de simd/matrix.h
+bool RunGlmTransformBenchmark() {
+
+#if GLM_CONFIG_SIMD == GLM_ENABLE && GLM_CONFIG_ALIGNED_GENTYPES == GLM_ENABLE
+	std::vector<glm::vec3> positions(BENCHMARK_OBJECT_COUNT), rotations(BENCHMARK_OBJECT_COUNT), scales(BENCHMARK_OBJECT_COUNT);
+	for (size_t i = 0; i < BENCHMARK_OBJECT_COUNT; i++) {
+		float t = static_cast<float>(i) * 0.001f;
+		positions[i] = glm::vec3(std::sin(t), std::cos(t * 0.7f), std::sin(t * 0.3f));
+		rotations[i] = glm::vec3(t * 3.f, -t * 5.f - 1.f, t * 7.f);
+		scales[i] = glm::vec3(0.5f + std::abs(std::sin(t)), 1.f, 1.5f);
+	}
+	std::vector<glm::mat4> packed(BENCHMARK_OBJECT_COUNT);
+	std::vector<glm::aligned_mat4> aligned(BENCHMARK_OBJECT_COUNT);
+
+	//Misma cadena que usaba la escena: rotate(translate(scale(...))) en grados sobre el eje de rotacion
+	double packedMilliseconds = 1e30, alignedMilliseconds = 1e30;
+	for (int repetition = 0; repetition < BENCHMARK_REPETITIONS; repetition++) {
+		auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < BENCHMARK_OBJECT_COUNT; i++) {
+			glm::mat4 model = glm::rotate(glm::mat4(1.f), glm::radians(rotations[i].y), rotations[i]);
+			model = glm::translate(model, positions[i]);
+			packed[i] = glm::scale(model, scales[i]);
+		}
+		packedMilliseconds = std::min(packedMilliseconds, MillisecondsSince(start));
+
+		start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < BENCHMARK_OBJECT_COUNT; i++) {
+			glm::aligned_vec3 axis(rotations[i]);
+			glm::aligned_mat4 model = glm::rotate(glm::aligned_mat4(1.f), glm::radians(rotations[i].y), axis);
+			model = glm::translate(model, glm::aligned_vec3(positions[i]));
+			aligned[i] = glm::scale(model, glm::aligned_vec3(scales[i]));
+		}
+		alignedMilliseconds = std::min(alignedMilliseconds, MillisecondsSince(start));
+	}
+
+	float difference = 0.f;
+	for (size_t i = 0; i < BENCHMARK_OBJECT_COUNT; i++)
+		difference = std::max(difference, MaxDifference(packed[i], glm::mat4(aligned[i])));
+
+	double nanoseconds = 1000000.0 / BENCHMARK_OBJECT_COUNT;
+	std::cout << "glm::rotate/translate/scale (" << BENCHMARK_OBJECT_COUNT << " matrices, ns por matriz)" << std::endl;
+	std::cout << "  glm::mat4, escalar:      " << packedMilliseconds * nanoseconds << " ns" << std::endl;
+	std::cout << "  glm::aligned_mat4, SIMD: " << alignedMilliseconds * nanoseconds << " ns, x"
+		<< packedMilliseconds / alignedMilliseconds << " (diferencia maxima " << difference << ")" << std::endl;
+	return difference <= BENCHMARK_TRANSFORM_EPSILON;
+#else
+	std::cout << "glm::rotate/translate/scale: sin GLM_FORCE_INTRINSICS o sin tipos alineados, no hay version SIMD que medir" << std::endl;
+	return true;
+#endif
+}
+
+
+//Transformacion por lotes de simd/matrix.h (AVX2/FMA si se compila con ENABLE_AVX2) contra un bucle de glm::mat4
+bool RunSimdBatchBenchmark() {
+
+#if GLM_CONFIG_SIMD == GLM_ENABLE && GLM_CONFIG_ALIGNED_GENTYPES == GLM_ENABLE
+	glm::mat4 transform = ComposeModelMatrix(glm::vec3(1.f, -2.f, 3.f), glm::vec3(1.f, 2.f, 3.f), 30.f, glm::vec3(2.f));
+	glm::aligned_mat4 alignedTransform(transform);
+
+	std::vector<glm::vec4> points(BENCHMARK_OBJECT_COUNT), transformed(BENCHMARK_OBJECT_COUNT);
+	std::vector<glm::aligned_vec4> alignedPoints(BENCHMARK_OBJECT_COUNT), alignedTransformed(BENCHMARK_OBJECT_COUNT);
+	for (size_t i = 0; i < BENCHMARK_OBJECT_COUNT; i++) {
+		float t = static_cast<float>(i) * 0.001f;
+		points[i] = glm::vec4(std::sin(t), std::cos(t * 0.7f), t, 1.f);
+		alignedPoints[i] = glm::aligned_vec4(points[i]);
+	}
+
+	double vectorMilliseconds = 1e30, vectorBatchMilliseconds = 1e30;
+	for (int repetition = 0; repetition < BENCHMARK_REPETITIONS; repetition++) {
+		auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < BENCHMARK_OBJECT_COUNT; i++)
+			transformed[i] = transform * points[i];
+		vectorMilliseconds = std::min(vectorMilliseconds, MillisecondsSince(start));
+
+		start = std::chrono::steady_clock::now();
+		glm_mat4_mul_vec4_batch(&alignedTransform[0].data, &alignedPoints[0].data, &alignedTransformed[0].data, BENCHMARK_OBJECT_COUNT);
+		vectorBatchMilliseconds = std::min(vectorBatchMilliseconds, MillisecondsSince(start));
+	}
+
+	float vectorDifference = 0.f;
+	for (size_t i = 0; i < BENCHMARK_OBJECT_COUNT; i++) {
+		glm::vec4 difference = glm::abs(transformed[i] - glm::vec4(alignedTransformed[i]));
+		vectorDifference = std::max(vectorDifference, glm::max(glm::max(difference.x, difference.y), glm::max(difference.z, difference.w)));
+	}
+
+	std::cout << "Lotes SIMD (" << BENCHMARK_OBJECT_COUNT << " vec4, " << BENCHMARK_OBJECT_COUNT / 4 << " mat4)" << std::endl;
+	std::cout << "  mat4 * vec4, bucle:      " << vectorMilliseconds << " ms" << std::endl;
+	std::cout << "  mat4 * vec4, lote:       " << vectorBatchMilliseconds << " ms, x"
+		<< vectorMilliseconds / vectorBatchMilliseconds << " (diferencia maxima " << vectorDifference << ")" << std::endl;
+
+	//glm_mat4_mul_batch solo existe con AVX2; con SSE no gana a un bucle de glm_mat4_mul
+#if GLM_ARCH & GLM_ARCH_AVX2_BIT
+	//Una cuarta parte de matrices para no pasar de ~200 MB entre todos los arrays
+	size_t matrixCount = BENCHMARK_OBJECT_COUNT / 4;
+	std::vector<glm::mat4> models(matrixCount), products(matrixCount);
+	std::vector<glm::aligned_mat4> alignedModels(matrixCount), alignedProducts(matrixCount);
+	for (size_t i = 0; i < matrixCount; i++) {
+		models[i] = ComposeModelMatrix(glm::vec3(points[i]), glm::vec3(points[i].y, 1.f, points[i].x), static_cast<float>(i), glm::vec3(1.f));
+		alignedModels[i] = glm::aligned_mat4(models[i]);
+	}
+	std::vector<glm::aligned_mat4> alignedTransforms(matrixCount, alignedTransform);
+
+	double matrixMilliseconds = 1e30, matrixBatchMilliseconds = 1e30;
+	for (int repetition = 0; repetition < BENCHMARK_REPETITIONS; repetition++) {
+		auto start = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < matrixCount; i++)
+			products[i] = transform * models[i];
+		matrixMilliseconds = std::min(matrixMilliseconds, MillisecondsSince(start));
+
+		start = std::chrono::steady_clock::now();
+		glm_mat4_mul_batch(&alignedTransforms[0][0].data, &alignedModels[0][0].data, &alignedProducts[0][0].data, matrixCount);
+		matrixBatchMilliseconds = std::min(matrixBatchMilliseconds, MillisecondsSince(start));
+	}
+
+	float matrixDifference = 0.f;
+	for (size_t i = 0; i < matrixCount; i++)
+		matrixDifference = std::max(matrixDifference, MaxDifference(products[i], glm::mat4(alignedProducts[i])));
+
+	std::cout << "  mat4 * mat4, bucle:      " << matrixMilliseconds << " ms" << std::endl;
+	std::cout << "  mat4 * mat4, lote:       " << matrixBatchMilliseconds << " ms, x"
+		<< matrixMilliseconds / matrixBatchMilliseconds << " (diferencia maxima " << matrixDifference << ")" << std::endl;
+	return vectorDifference <= BENCHMARK_EPSILON && matrixDifference <= BENCHMARK_EPSILON;
+#else
+	std::cout << "  mat4 * mat4, lote:       solo con ENABLE_AVX2" << std::endl;
+	return vectorDifference <= BENCHMARK_EPSILON;
+#endif
+#else
+	std::cout << "Lotes SIMD: sin GLM_FORCE_INTRINSICS o sin tipos alineados, no hay version SIMD que medir" << std::endl;
+	return true;
+#endif
+}
+
+
+//Rejilla plana de size x size quads como triangulos sin indexar (x, y, z por vertice)
+std::vector<GLfloat> GridTriangles(int size) {
+
+	std::vector<GLfloat> triangles;
+	triangles.reserve(static_cast<size_t>(size) * size * 18);
+	for (int y = 0; y < size; y++) {
+		for (int x = 0; x < size; x++) {
+			float x0 = static_cast<float>(x), x1 = x0 + 1.f, y0 = static_cast<float>(y), y1 = y0 + 1.f;
+			GLfloat quad[] = { x0, y0, 0.f, x1, y0, 0.f, x1, y1, 0.f, x0, y0, 0.f, x1, y1, 0.f, x0, y1, 0.f };
+			triangles.insert(triangles.end(), quad, quad + 18);
+		}
+	}
+
+	return triangles;
+}
+
+
+//Rejilla de triangulos sin indexar en orden aleatorio, como sale de muchos exportadores: deduplicacion,
+//ACMR antes y despues de reordenar para la cache de vertices y memoria ocupada
+bool RunMeshBenchmark() {
+
+	std::vector<GLfloat> triangles = GridTriangles(BENCHMARK_GRID_SIZE);
+
+	//Barajamos los triangulos (no sus vertices) con semilla fija para que el resultado sea repetible
+	size_t triangleCount = triangles.size() / 9;
+	std::vector<size_t> order(triangleCount);
+	for (size_t i = 0; i < triangleCount; i++)
+		order[i] = i;
+	std::shuffle(order.begin(), order.end(), std::mt19937(1234));
+	std::vector<GLfloat> shuffled(triangles.size());
+	for (size_t i = 0; i < triangleCount; i++)
+		std::copy(triangles.begin() + order[i] * 9, triangles.begin() + order[i] * 9 + 9, shuffled.begin() + i * 9);
+
+	auto start = std::chrono::steady_clock::now();
+	MeshBuilder builder;
+	AddTriangles(builder, shuffled.data(), triangleCount * 3);
+	double buildMilliseconds = MillisecondsSince(start);
+	float shuffledACMR = ComputeACMR(builder.mesh);
+
+	start = std::chrono::steady_clock::now();
+	OptimizeVertexCache(builder.mesh);
+	OptimizeVertexFetch(builder.mesh);
+	double optimizeMilliseconds = MillisecondsSince(start);
+	float optimizedACMR = ComputeACMR(builder.mesh);
+
+	size_t unindexedBytes = shuffled.size() * sizeof(GLfloat);
+	size_t indexedBytes = builder.mesh.positions.size() * sizeof(glm::vec3) + builder.mesh.indices.size() * sizeof(GLuint);
+
+	std::cout << "Malla indexada (" << triangleCount << " triangulos, cache FIFO de " << VERTEX_CACHE_FIFO_SIZE << " vertices)" << std::endl;
+	std::cout << "  deduplicar:              " << buildMilliseconds << " ms, " << triangleCount * 3 << " -> "
+		<< builder.mesh.positions.size() << " vertices, " << unindexedBytes / 1024 << " -> " << indexedBytes / 1024 << " KB" << std::endl;
+	std::cout << "  optimizar cache:         " << optimizeMilliseconds << " ms, ACMR " << shuffledACMR << " -> " << optimizedACMR << std::endl;
+
+	//La rejilla tiene (lado + 1)^2 vertices distintos y optimizar no puede perder triangulos ni empeorar la cache
+	size_t gridVertices = static_cast<size_t>(BENCHMARK_GRID_SIZE + 1) * (BENCHMARK_GRID_SIZE + 1);
+	return builder.mesh.positions.size() == gridVertices && builder.mesh.indices.size() == triangleCount * 3 && optimizedACMR <= shuffledACMR;
+}
+
+
+//Carga de una malla grande: reconstruirla desde triangulos sueltos contra mapear su archivo .mesh y leer los
+//bloques que se pasarian a glBufferStorage. El archivo esta recien escrito, asi que se lee de la cache del sistema
+bool RunMeshFileBenchmark() {
+
+	std::vector<GLfloat> triangles = GridTriangles(BENCHMARK_MESH_FILE_GRID_SIZE);
+
+	auto start = std::chrono::steady_clock::now();
+	MeshBuilder builder;
+	AddTriangles(builder, triangles.data(), triangles.size() / 3);
+	double buildMilliseconds = MillisecondsSince(start);
+
+	std::filesystem::path directory = std::filesystem::temp_directory_path() / "MyFirstOpenGLBenchmark";
+	std::filesystem::create_directories(directory);
+	std::string filePath = (directory / "Rejilla.mesh").string();
+	if (!WriteMeshFile(filePath, builder.mesh))
+		return false;
+
+	start = std::chrono::steady_clock::now();
+	MeshFile file;
+	unsigned int checksum = 0;
+	bool mapped = MapMeshFile(filePath, file);
+	if (mapped) {
+		//Tocamos una palabra por cada 64 bytes para forzar que se carguen todas las paginas
+		for (std::uint64_t i = 0; i < file.header->vertexSize; i += 64)
+			checksum += file.vertexData[i];
+		for (std::uint64_t i = 0; i < file.header->indexSize; i += 64)
+			checksum += file.indexData[i];
+	}
+	double mapMilliseconds = MillisecondsSince(start);
+	double megabytes = static_cast<double>(file.view.size) / (1024.0 * 1024.0);
+
+	//Fuera de la medida: los bloques mapeados tienen que ser los mismos vertices e indices que se escribieron
+	const MeshData& mesh = builder.mesh;
+	bool match = mapped && file.header->vertexCount == mesh.positions.size() && file.header->indexCount == mesh.indices.size()
+		&& std::memcmp(file.vertexData, mesh.positions.data(), file.header->vertexSize) == 0;
+	for (size_t i = 0; match && i < mesh.indices.size(); i++) {
+		std::uint32_t index = file.header->indexType == GL_UNSIGNED_SHORT
+			? reinterpret_cast<const GLushort*>(file.indexData)[i] : reinterpret_cast<const GLuint*>(file.indexData)[i];
+		match = index == mesh.indices[i];
+	}
+	UnmapMeshFile(file);
+
+	std::cout << "Archivo .mesh (" << triangles.size() / 9 << " triangulos, " << megabytes << " MB, checksum " << checksum
+		<< (match ? ")" : ", RESULTADOS DISTINTOS)") << std::endl;
+	std::cout << "  desde triangulos:        " << buildMilliseconds << " ms" << std::endl;
+	std::cout << "  mapeado:                 " << mapMilliseconds << " ms (" << megabytes / (mapMilliseconds / 1000.0) << " MB/s), x"
+		<< buildMilliseconds / mapMilliseconds << std::endl;
+
+	std::error_code error;
+	std::filesystem::remove_all(directory, error);
+	return match;
+}
+
+
+//Rejilla de size x size quads como OBJ (caras de cuatro esquinas) y como .glb (triangulos indexados)
+bool WriteGridModels(int size, const std::string& objPath, const std::string& glbPath) {
+
+	std::vector<GLfloat> positions;
+	std::vector<GLuint> indices;
+	std::ofstream obj(objPath, std::ios::trunc);
+	obj << "# Rejilla de benchmark\no Rejilla\n";
+
+	for (int y = 0; y <= size; y++) {
+		for (int x = 0; x <= size; x++) {
+			GLfloat position[3] = { static_cast<GLfloat>(x), static_cast<GLfloat>(y), 0.f };
+			positions.insert(positions.end(), position, position + 3);
+			obj << "v " << position[0] << ' ' << position[1] << ' ' << position[2] << '\n';
+		}
+	}
+
+	for (int y = 0; y < size; y++) {
+		for (int x = 0; x < size; x++) {
+			GLuint corner = static_cast<GLuint>(y * (size + 1) + x);
+			GLuint quad[4] = { corner, corner + 1, corner + size + 2, corner + size + 1 };
+			obj << "f " << quad[0] + 1 << ' ' << quad[1] + 1 << ' ' << quad[2] + 1 << ' ' << quad[3] + 1 << '\n';
+			indices.insert(indices.end(), { quad[0], quad[1], quad[2], quad[0], quad[2], quad[3] });
+		}
+	}
+
+	if (!obj)
+		return false;
+
+	size_t positionBytes = positions.size() * sizeof(GLfloat);
+	size_t indexBytes = indices.size() * sizeof(GLuint);
+	std::string json = "{\"asset\":{\"version\":\"2.0\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"mesh\":0}],"
+		"\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0},\"indices\":1}]}],"
+		"\"accessors\":[{\"bufferView\":0,\"componentType\":5126,\"count\":" + std::to_string(positions.size() / 3) + ",\"type\":\"VEC3\"},"
+		"{\"bufferView\":1,\"componentType\":5125,\"count\":" + std::to_string(indices.size()) + ",\"type\":\"SCALAR\"}],"
+		"\"bufferViews\":[{\"buffer\":0,\"byteLength\":" + std::to_string(positionBytes) + "},"
+		"{\"buffer\":0,\"byteOffset\":" + std::to_string(positionBytes) + ",\"byteLength\":" + std::to_string(indexBytes) + "}],"
+		"\"buffers\":[{\"byteLength\":" + std::to_string(positionBytes + indexBytes) + "}]}";
+
+	//Los bloques de un .glb miden multiplos de 4 bytes; el JSON se rellena con espacios
+	json.resize((json.size() + 3) / 4 * 4, ' ');
+
+	std::uint32_t header[3] = { 0x46546C67u, 2, static_cast<std::uint32_t>(12 + 8 + json.size() + 8 + positionBytes + indexBytes) };
+	std::uint32_t jsonChunk[2] = { static_cast<std::uint32_t>(json.size()), 0x4E4F534Au };
+	std::uint32_t binaryChunk[2] = { static_cast<std::uint32_t>(positionBytes + indexBytes), 0x004E4942u };
+
+	std::ofstream glb(glbPath, std::ios::binary | std::ios::trunc);
+	glb.write(reinterpret_cast<const char*>(header), sizeof(header));
+	glb.write(reinterpret_cast<const char*>(jsonChunk), sizeof(jsonChunk));
+	glb.write(json.data(), json.size());
+	glb.write(reinterpret_cast<const char*>(binaryChunk), sizeof(binaryChunk));
+	glb.write(reinterpret_cast<const char*>(positions.data()), positionBytes);
+	glb.write(reinterpret_cast<const char*>(indices.data()), indexBytes);
+	return static_cast<bool>(glb);
+}
+
+
+//Mismos indices y mismas posiciones salvo el redondeo del texto del OBJ
+bool MeshesMatch(const MeshData& a, const MeshData& b, float epsilon) {
+
+	if (a.positions.size() != b.positions.size() || a.indices != b.indices)
+		return false;
+
+	for (size_t i = 0; i < a.positions.size(); i++) {
+		glm::vec3 difference = glm::abs(a.positions[i] - b.positions[i]);
+		if (glm::max(glm::max(difference.x, difference.y), difference.z) > epsilon)
+			return false;
+	}
+
+	return true;
+}
+
+
+bool RunModelImportBenchmark() {
+
+	std::filesystem::path directory = std::filesystem::temp_directory_path() / "MyFirstOpenGLBenchmark";
+	std::filesystem::create_directories(directory);
+	std::string objPath = (directory / "Rejilla.obj").string();
+	std::string glbPath = (directory / "Rejilla.glb").string();
+	if (!WriteGridModels(BENCHMARK_IMPORT_GRID_SIZE, objPath, glbPath))
+		return false;
+
+	std::cout << "Importar modelos (rejilla de " << BENCHMARK_IMPORT_GRID_SIZE << "x" << BENCHMARK_IMPORT_GRID_SIZE << " quads)" << std::endl;
+
+	const std::string* paths[] = { &objPath, &glbPath };
+	size_t workerCounts[] = { 0, DefaultWorkerCount() };
+
+	//Cada importacion se compara con la primera: los dos formatos y cualquier numero de hilos dan la misma malla
+	MeshData reference;
+	bool match = true;
+
+	for (int format = 0; format < 2; format++) {
+		double megabytes = static_cast<double>(std::filesystem::file_size(*paths[format])) / (1024.0 * 1024.0);
+
+		//Con un solo nucleo DefaultWorkerCount es 0 y la segunda pasada seria la misma
+		for (int run = 0; run < (workerCounts[1] > 0 ? 2 : 1); run++) {
+			size_t workerCount = workerCounts[run];
+			JobSystem jobSystem;
+			CreateJobSystem(jobSystem, workerCount);
+
+			MeshData mesh;
+			auto start = std::chrono::steady_clock::now();
+			bool imported = ImportModel(*paths[format], mesh, jobSystem);
+			double milliseconds = MillisecondsSince(start);
+			DestroyJobSystem(jobSystem);
+
+			if (!imported) {
+				match = false;
+				break;
+			}
+
+			if (reference.positions.empty())
+				reference = mesh;
+			else
+				match = match && MeshesMatch(reference, mesh, BENCHMARK_IMPORT_EPSILON);
+
+			std::cout << "  " << (format == 0 ? ".obj" : ".glb") << " (" << megabytes << " MB), " << workerCount << " hilos extra: "
+				<< milliseconds << " ms (" << megabytes / (milliseconds / 1000.0) << " MB/s)" << std::endl;
+		}
+	}
+
+	match = match && !reference.positions.empty();
+	std::cout << "  " << reference.positions.size() << " vertices, " << reference.indices.size() / 3 << " triangulos, OBJ y GLB "
+		<< (match ? "coinciden" : "NO coinciden") << std::endl;
+
+	std::error_code error;
+	std::filesystem::remove_all(directory, error);
+	return match;
+}
+
+
+bool RunCullingBenchmark() {
+
+	std::mt19937 random(21);
+	std::uniform_real_distribution<float> position(-BENCHMARK_CULL_EXTENT, BENCHMARK_CULL_EXTENT);
+	std::uniform_real_distribution<float> size(0.02f, 0.1f);
+
+	SphereArray spheres;
+	ResizeSphereArray(spheres, BENCHMARK_CULL_OBJECTS);
+	for (size_t i = 0; i < BENCHMARK_CULL_OBJECTS; i++)
+		SetSphere(spheres, i, glm::vec3(position(random), position(random), 0.f), size(random));
+
+	Camera camera;
+	glm::mat4 viewProjection = CameraViewProjection(camera);
+	Frustum frustum = ExtractFrustum(viewProjection);
+	std::vector<std::uint32_t> visible(BENCHMARK_CULL_OBJECTS), visibleScalar(BENCHMARK_CULL_OBJECTS);
+
+	size_t visibleCount = 0, visibleScalarCount = 0;
+	double scalarMilliseconds = 1e30, simdMilliseconds = 1e30;
+	for (int repetition = 0; repetition < BENCHMARK_REPETITIONS; repetition++) {
+		auto start = std::chrono::steady_clock::now();
+		visibleScalarCount = CullSpheresScalar(frustum, spheres, 0, BENCHMARK_CULL_OBJECTS, visibleScalar.data());
+		scalarMilliseconds = std::min(scalarMilliseconds, MillisecondsSince(start));
+
+		start = std::chrono::steady_clock::now();
+		visibleCount = CullSpheres(frustum, spheres, 0, BENCHMARK_CULL_OBJECTS, visible.data());
+		simdMilliseconds = std::min(simdMilliseconds, MillisecondsSince(start));
+	}
+
+	bool match = visibleCount == visibleScalarCount && std::equal(visible.begin(), visible.begin() + visibleCount, visibleScalar.begin());
+	std::cout << "Frustum culling (" << BENCHMARK_CULL_OBJECTS << " esferas, " << visibleCount << " visibles, "
+		<< (match ? "mismo resultado" : "RESULTADOS DISTINTOS") << ")" << std::endl;
+	std::cout << "  esfera a esfera:         " << scalarMilliseconds << " ms" << std::endl;
+	std::cout << "  lotes SIMD:              " << simdMilliseconds << " ms, x" << scalarMilliseconds / simdMilliseconds << std::endl;
+
+	//Hi-Z: un oclusor que tapa la mitad izquierda de la pantalla cerca de la camara y objetos detras de el
+	const int width = 640, height = 480;
+	std::vector<float> depth(static_cast<size_t>(width) * height, 1.f);
+	for (int y = 0; y < height; y++)
+		std::fill(depth.begin() + static_cast<size_t>(y) * width, depth.begin() + static_cast<size_t>(y) * width + width / 2, 0.25f);
+
+	auto start = std::chrono::steady_clock::now();
+	HiZBuffer hiZ;
+	BuildHiZBuffer(hiZ, depth.data(), width, height);
+	double buildMilliseconds = MillisecondsSince(start);
+
+	//La camara mira hacia -Z; con z = -0.5 la profundidad es 0.75, detras del oclusor
+	start = std::chrono::steady_clock::now();
+	std::vector<bool> unoccluded(visibleCount);
+	for (size_t i = 0; i < visibleCount; i++) {
+		std::uint32_t index = visible[i];
+		glm::vec3 center(spheres.centerX[index], spheres.centerY[index], -0.5f);
+		unoccluded[i] = IsSphereUnoccluded(hiZ, viewProjection, center, spheres.radius[index]);
+	}
+	double testMilliseconds = MillisecondsSince(start);
+
+	//Referencia sobre los visibles del frustum: una esfera esta oculta si toda su caja cae en la mitad izquierda.
+	//Hi-Z es conservador, puede dejar visible alguna oculta en el borde del oclusor pero nunca ocultar una visible
+	size_t occluded = 0, referenceOccluded = 0, wronglyOccluded = 0;
+	for (size_t i = 0; i < visibleCount; i++) {
+		std::uint32_t index = visible[i];
+		float right = (viewProjection * glm::vec4(spheres.centerX[index] + spheres.radius[index], 0.f, -0.5f, 1.f)).x;
+		bool hidden = right < 0.f;
+		occluded += unoccluded[i] ? 0 : 1;
+		referenceOccluded += hidden ? 1 : 0;
+		wronglyOccluded += (!unoccluded[i] && !hidden) ? 1 : 0;
+	}
+	bool occlusionMatch = wronglyOccluded == 0 && occluded * 10 >= referenceOccluded * 9;
+
+	std::cout << "Oclusion Hi-Z (" << width << "x" << height << ", " << hiZ.levels.size() << " niveles): " << occluded << " de "
+		<< visibleCount << " ocultos (referencia " << referenceOccluded << (occlusionMatch ? ")" : ", RESULTADOS DISTINTOS)")
+		<< ", piramide " << buildMilliseconds << " ms, pruebas " << testMilliseconds << " ms" << std::endl;
+	return match && occlusionMatch;
+}
+
+
+bool RunBvhBenchmark() {
+
+	std::mt19937 random(22);
+	std::uniform_real_distribution<float> position(-BENCHMARK_CULL_EXTENT, BENCHMARK_CULL_EXTENT);
+	std::uniform_real_distribution<float> size(0.02f, 0.1f);
+	std::uniform_real_distribution<float> step(-0.01f, 0.01f);
+
+	std::vector<Bounds> bounds(BENCHMARK_CULL_OBJECTS);
+	for (Bounds& box : bounds) {
+		glm::vec3 center(position(random), position(random), position(random) * 0.1f);
+		glm::vec3 halfExtent(size(random));
+		box.min = center - halfExtent;
+		box.max = center + halfExtent;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	Bvh bvh;
+	BuildBvh(bvh, bounds);
+	double buildMilliseconds = MillisecondsSince(start);
+	float builtCost = bvh.builtCost;
+
+	//Movemos todas las cajas un poco, como un paso de simulacion, y ajustamos el arbol
+	for (Bounds& box : bounds) {
+		glm::vec3 offset(step(random), step(random), 0.f);
+		box.min += offset;
+		box.max += offset;
+	}
+	start = std::chrono::steady_clock::now();
+	RefitBvh(bvh, bounds);
+	double refitMilliseconds = MillisecondsSince(start);
+
+	std::cout << "BVH (" << BENCHMARK_CULL_OBJECTS << " cajas, " << bvh.nodes.size() << " nodos de " << sizeof(BvhNode) << " bytes)" << std::endl;
+	std::cout << "  construir (SAH):         " << buildMilliseconds << " ms, coste " << builtCost << std::endl;
+	std::cout << "  refit:                   " << refitMilliseconds << " ms, coste " << ComputeBvhCost(bvh) << std::endl;
+
+	//Frustum: consulta del arbol frente a probar todas las cajas
+	Camera camera;
+	camera.nearPlane = -BENCHMARK_CULL_EXTENT;
+	camera.farPlane = BENCHMARK_CULL_EXTENT;
+	Frustum frustum = ExtractFrustum(CameraViewProjection(camera));
+
+	std::vector<std::uint32_t> visible, visibleLinear;
+	start = std::chrono::steady_clock::now();
+	QueryBvhFrustum(bvh, bounds, frustum, visible);
+	double queryMilliseconds = MillisecondsSince(start);
+
+	start = std::chrono::steady_clock::now();
+	for (std::uint32_t i = 0; i < bounds.size(); i++)
+		if (IsBoxVisible(frustum, bounds[i], glm::mat4(1.f)))
+			visibleLinear.push_back(i);
+	double linearMilliseconds = MillisecondsSince(start);
+
+	std::sort(visible.begin(), visible.end());
+	std::cout << "  frustum, todas:          " << linearMilliseconds << " ms, " << visibleLinear.size() << " visibles" << std::endl;
+	std::cout << "  frustum, BVH:            " << queryMilliseconds << " ms, " << visible.size() << " visibles"
+		<< (visible == visibleLinear ? "" : " (RESULTADOS DISTINTOS)") << ", x" << linearMilliseconds / queryMilliseconds << std::endl;
+
+	//Rayos de la camara hacia -Z por puntos al azar de la pantalla: el primer impacto debe coincidir
+	std::vector<glm::vec2> rays(BENCHMARK_RAY_COUNT);
+	for (glm::vec2& ray : rays)
+		ray = glm::vec2(position(random), position(random)) / BENCHMARK_CULL_EXTENT;
+
+	int hits = 0, mismatches = 0;
+	double bvhRayMilliseconds = 0.0, linearRayMilliseconds = 0.0;
+	for (const glm::vec2& ray : rays) {
+		glm::vec3 origin, direction;
+		CameraRay(camera, ray, origin, direction);
+
+		start = std::chrono::steady_clock::now();
+		std::uint32_t hitItem = 0;
+		float hitDistance = 0.f;
+		bool hit = RaycastBvh(bvh, bounds, origin, direction, hitItem, hitDistance);
+		bvhRayMilliseconds += MillisecondsSince(start);
+
+		//Referencia: slab contra todas las cajas
+		start = std::chrono::steady_clock::now();
+		float nearest = 1e30f;
+		for (const Bounds& box : bounds) {
+			glm::vec3 t0 = (box.min - origin) / direction, t1 = (box.max - origin) / direction;
+			glm::vec3 tNear = glm::min(t0, t1), tFar = glm::max(t0, t1);
+			float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.f));
+			float exit = std::min(std::min(tFar.x, tFar.y), tFar.z);
+			if (enter <= exit)
+				nearest = std::min(nearest, enter);
+		}
+		linearRayMilliseconds += MillisecondsSince(start);
+
+		hits += hit ? 1 : 0;
+		mismatches += (hit != (nearest < 1e30f) || (hit && std::abs(hitDistance - nearest) > 1e-5f)) ? 1 : 0;
+	}
+
+	std::cout << "  " << BENCHMARK_RAY_COUNT << " rayos, todas:       " << linearRayMilliseconds << " ms" << std::endl;
+	std::cout << "  " << BENCHMARK_RAY_COUNT << " rayos, BVH:         " << bvhRayMilliseconds << " ms, " << hits << " impactos"
+		<< (mismatches == 0 ? "" : " (RESULTADOS DISTINTOS)") << ", x" << linearRayMilliseconds / bvhRayMilliseconds << std::endl;
+	return visible == visibleLinear && mismatches == 0;
+}
+
+
+bool RunRenderQueueBenchmark() {
+
+	std::mt19937 random(25);
+	std::uniform_int_distribution<std::uint32_t> program(1, 8), vertexArray(1, 16), material(0, 31);
+	std::uniform_real_distribution<float> depth(0.f, 1.f);
+
+	std::vector<std::uint64_t> sourceKeys(BENCHMARK_QUEUE_COMMANDS);
+	for (std::uint64_t& key : sourceKeys)
+		key = MakeSortKey(0, program(random), vertexArray(random), material(random), depth(random));
+
+	std::vector<std::uint64_t> keys, keyScratch;
+	std::vector<std::uint32_t> order, orderScratch;
+	std::vector<std::pair<std::uint64_t, std::uint32_t>> pairs(BENCHMARK_QUEUE_COMMANDS);
+
+	double stdSortMilliseconds = 1e30, radixMilliseconds = 1e30;
+	for (int repetition = 0; repetition < BENCHMARK_REPETITIONS; repetition++) {
+		for (std::uint32_t i = 0; i < BENCHMARK_QUEUE_COMMANDS; i++)
+			pairs[i] = { sourceKeys[i], i };
+
+		auto start = std::chrono::steady_clock::now();
+		std::stable_sort(pairs.begin(), pairs.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+		stdSortMilliseconds = std::min(stdSortMilliseconds, MillisecondsSince(start));
+
+		keys = sourceKeys;
+		order.resize(BENCHMARK_QUEUE_COMMANDS);
+		for (std::uint32_t i = 0; i < BENCHMARK_QUEUE_COMMANDS; i++)
+			order[i] = i;
+
+		start = std::chrono::steady_clock::now();
+		RadixSortKeys(keys, order, keyScratch, orderScratch);
+		radixMilliseconds = std::min(radixMilliseconds, MillisecondsSince(start));
+	}
+
+	//Los dos son estables, asi que tambien los indices tienen que salir en el mismo orden
+	bool match = true;
+	for (size_t i = 0; i < BENCHMARK_QUEUE_COMMANDS && match; i++)
+		match = keys[i] == pairs[i].first && order[i] == pairs[i].second;
+
+	std::cout << "Orden de la cola de render (" << BENCHMARK_QUEUE_COMMANDS << " claves, "
+		<< (match ? "mismo resultado" : "RESULTADOS DISTINTOS") << ")" << std::endl;
+	std::cout << "  std::stable_sort:        " << stdSortMilliseconds << " ms" << std::endl;
+	std::cout << "  radix sort:              " << radixMilliseconds << " ms, x" << stdSortMilliseconds / radixMilliseconds << std::endl;
+	return match;
+}
+
+
+bool RunBenchmarks() {
+
+	//Se ejecutan todos aunque alguno falle, para ver todas las medidas
+	bool passed = true;
+	passed = RunFileLoadBenchmark() && passed;
+	passed = RunGameObjectBenchmark() && passed;
+	passed = RunJobSystemBenchmark() && passed;
+	passed = RunModelMatrixBenchmark() && passed;
+	passed = RunGlmTransformBenchmark() && passed;
+	passed = RunSimdBatchBenchmark() && passed;
+	passed = RunMeshBenchmark() && passed;
+	passed = RunMeshFileBenchmark() && passed;
+	passed = RunModelImportBenchmark() && passed;
+	passed = RunCullingBenchmark() && passed;
+	passed = RunBvhBenchmark() && passed;
+	passed = RunRenderQueueBenchmark() && passed;
+
+	if (!passed)
+		std::cerr << "Alguna comprobacion de los benchmarks ha fallado" << std::endl;
+	return passed;
+}
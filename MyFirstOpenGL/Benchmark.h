@@ -0,0 +1,30 @@
+#pragma once
+
+//Micro-benchmarks de CPU que no necesitan contexto de OpenGL (se lanzan con --benchmark). Cada uno comprueba que
+//la version rapida da el mismo resultado que la de referencia y devuelve false si no es asi
+
+bool RunFileLoadBenchmark();
+
+bool RunGameObjectBenchmark();
+
+bool RunJobSystemBenchmark();
+
+bool RunModelMatrixBenchmark();
+
+bool RunGlmTransformBenchmark();
+
+bool RunSimdBatchBenchmark();
+
+bool RunMeshBenchmark();
+
+bool RunMeshFileBenchmark();
+
+bool RunModelImportBenchmark();
+
+bool RunCullingBenchmark();
+
+bool RunBvhBenchmark();
+
+bool RunRenderQueueBenchmark();
+
+bool RunBenchmarks();
@@ -0,0 +1,325 @@
+#include "Bvh.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <utility>
+
+
+float SurfaceArea(const glm::vec3& min, const glm::vec3& max) {
+
+	glm::vec3 size = glm::max(max - min, glm::vec3(0.f));
+	return 2.f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+
+//Caja de los elementos [first, first + count) de items
+void ComputeNodeBounds(BvhNode& node, const std::vector<std::uint32_t>& items, const std::vector<Bounds>& bounds) {
+
+	node.min = glm::vec3(FLT_MAX);
+	node.max = glm::vec3(-FLT_MAX);
+	for (std::uint32_t i = node.first; i < node.first + node.count; i++) {
+		node.min = glm::min(node.min, bounds[items[i]].min);
+		node.max = glm::max(node.max, bounds[items[i]].max);
+	}
+}
+
+
+//Busca con cubetas el eje y el plano de corte de menor coste SAH. Devuelve false si quedarse como hoja es mas barato
+bool FindBvhSplit(const BvhNode& node, const Bvh& bvh, const std::vector<Bounds>& bounds, const std::vector<glm::vec3>& centroids,
+	int& bestAxis, float& bestPosition) {
+
+	glm::vec3 centroidMin(FLT_MAX), centroidMax(-FLT_MAX);
+	for (std::uint32_t i = node.first; i < node.first + node.count; i++) {
+		centroidMin = glm::min(centroidMin, centroids[bvh.items[i]]);
+		centroidMax = glm::max(centroidMax, centroids[bvh.items[i]]);
+	}
+
+	struct Bin
+	{
+		glm::vec3 min = glm::vec3(FLT_MAX);
+		glm::vec3 max = glm::vec3(-FLT_MAX);
+		std::uint32_t count = 0;
+	};
+
+	float bestCost = FLT_MAX;
+	bestAxis = -1;
+
+	for (int axis = 0; axis < 3; axis++) {
+		float extent = centroidMax[axis] - centroidMin[axis];
+		if (extent <= 0.f)
+			continue;
+
+		Bin bins[BVH_BINS];
+		float scale = BVH_BINS / extent;
+		for (std::uint32_t i = node.first; i < node.first + node.count; i++) {
+			std::uint32_t item = bvh.items[i];
+			int bin = std::min(static_cast<int>((centroids[item][axis] - centroidMin[axis]) * scale), BVH_BINS - 1);
+			bins[bin].count++;
+			bins[bin].min = glm::min(bins[bin].min, bounds[item].min);
+			bins[bin].max = glm::max(bins[bin].max, bounds[item].max);
+		}
+
+		//Area y elementos a la izquierda de cada plano barriendo de izquierda a derecha, y a la derecha al reves
+		float leftArea[BVH_BINS - 1], rightArea[BVH_BINS - 1];
+		std::uint32_t leftCount[BVH_BINS - 1], rightCount[BVH_BINS - 1];
+		glm::vec3 leftMin(FLT_MAX), leftMax(-FLT_MAX), rightMin(FLT_MAX), rightMax(-FLT_MAX);
+		std::uint32_t leftSum = 0, rightSum = 0;
+		for (int plane = 0; plane < BVH_BINS - 1; plane++) {
+			leftSum += bins[plane].count;
+			leftMin = glm::min(leftMin, bins[plane].min);
+			leftMax = glm::max(leftMax, bins[plane].max);
+			leftCount[plane] = leftSum;
+			leftArea[plane] = leftSum > 0 ? SurfaceArea(leftMin, leftMax) : 0.f;
+
+			int rightBin = BVH_BINS - 1 - plane;
+			rightSum += bins[rightBin].count;
+			rightMin = glm::min(rightMin, bins[rightBin].min);
+			rightMax = glm::max(rightMax, bins[rightBin].max);
+			rightCount[rightBin - 1] = rightSum;
+			rightArea[rightBin - 1] = rightSum > 0 ? SurfaceArea(rightMin, rightMax) : 0.f;
+		}
+
+		for (int plane = 0; plane < BVH_BINS - 1; plane++) {
+			if (leftCount[plane] == 0 || rightCount[plane] == 0)
+				continue;
+			float cost = leftCount[plane] * leftArea[plane] + rightCount[plane] * rightArea[plane];
+			if (cost < bestCost) {
+				bestCost = cost;
+				bestAxis = axis;
+				bestPosition = centroidMin[axis] + extent * (plane + 1) / BVH_BINS;
+			}
+		}
+	}
+
+	//Coste de dejarlo como hoja frente a bajar un nivel mas (recorrer el nodo cuesta lo mismo que probar un elemento)
+	float area = SurfaceArea(node.min, node.max);
+	return bestAxis >= 0 && (node.count > BVH_MAX_LEAF_SIZE || area + bestCost < node.count * area);
+}
+
+
+void BuildBvh(Bvh& bvh, const std::vector<Bounds>& bounds) {
+
+	bvh.nodes.clear();
+	bvh.items.resize(bounds.size());
+	for (std::uint32_t i = 0; i < bounds.size(); i++)
+		bvh.items[i] = i;
+
+	if (bounds.empty()) {
+		bvh.builtCost = 0.f;
+		return;
+	}
+
+	std::vector<glm::vec3> centroids(bounds.size());
+	for (size_t i = 0; i < bounds.size(); i++)
+		centroids[i] = (bounds[i].min + bounds[i].max) * 0.5f;
+
+	//Como mucho 2n - 1 nodos; reservando no se invalidan las referencias al anadir hijos
+	bvh.nodes.reserve(bounds.size() * 2);
+	bvh.nodes.push_back(BvhNode{ glm::vec3(0.f), 0, glm::vec3(0.f), static_cast<std::uint32_t>(bounds.size()) });
+
+	//Nodos por partir con su profundidad. Los que llegan a BVH_MAX_DEPTH se quedan como hoja aunque sean grandes
+	std::vector<std::pair<std::uint32_t, int>> pending(1, std::make_pair(0u, 0));
+	while (!pending.empty()) {
+		std::uint32_t nodeIndex = pending.back().first;
+		int depth = pending.back().second;
+		pending.pop_back();
+
+		BvhNode& node = bvh.nodes[nodeIndex];
+		ComputeNodeBounds(node, bvh.items, bounds);
+		if (node.count <= 1 || depth >= BVH_MAX_DEPTH)
+			continue;
+
+		//Partimos los elementos por el plano elegido; si la SAH no separa nada y hay demasiados, por la mitad
+		std::uint32_t* begin = bvh.items.data() + node.first;
+		std::uint32_t* end = begin + node.count;
+		std::uint32_t* middle = begin;
+
+		int axis;
+		float position;
+		if (FindBvhSplit(node, bvh, bounds, centroids, axis, position))
+			middle = std::partition(begin, end, [&](std::uint32_t item) { return centroids[item][axis] < position; });
+		if ((middle == begin || middle == end) && node.count > BVH_MAX_LEAF_SIZE)
+			middle = begin + node.count / 2;
+
+		if (middle == begin || middle == end)
+			continue;
+
+		std::uint32_t leftCount = static_cast<std::uint32_t>(middle - begin);
+		std::uint32_t first = node.first;
+		std::uint32_t count = node.count;
+		std::uint32_t left = static_cast<std::uint32_t>(bvh.nodes.size());
+
+		node.first = left;
+		node.count = 0;
+		bvh.nodes.push_back(BvhNode{ glm::vec3(0.f), first, glm::vec3(0.f), leftCount });
+		bvh.nodes.push_back(BvhNode{ glm::vec3(0.f), first + leftCount, glm::vec3(0.f), count - leftCount });
+		pending.push_back(std::make_pair(left + 1, depth + 1));
+		pending.push_back(std::make_pair(left, depth + 1));
+	}
+
+	bvh.builtCost = ComputeBvhCost(bvh);
+}
+
+
+void RefitBvh(Bvh& bvh, const std::vector<Bounds>& bounds) {
+
+	for (size_t i = bvh.nodes.size(); i-- > 0;) {
+		BvhNode& node = bvh.nodes[i];
+		if (node.count > 0) {
+			ComputeNodeBounds(node, bvh.items, bounds);
+		}
+		else {
+			const BvhNode& left = bvh.nodes[node.first];
+			const BvhNode& right = bvh.nodes[node.first + 1];
+			node.min = glm::min(left.min, right.min);
+			node.max = glm::max(left.max, right.max);
+		}
+	}
+}
+
+
+float ComputeBvhCost(const Bvh& bvh) {
+
+	if (bvh.nodes.empty())
+		return 0.f;
+
+	float cost = 0.f;
+	for (const BvhNode& node : bvh.nodes)
+		cost += SurfaceArea(node.min, node.max) * (node.count > 0 ? static_cast<float>(node.count) : 1.f);
+
+	float rootArea = SurfaceArea(bvh.nodes[0].min, bvh.nodes[0].max);
+	return rootArea > 0.f ? cost / rootArea : 0.f;
+}
+
+
+//Distancia de entrada del rayo en la caja, o FLT_MAX si no la corta antes de maxDistance
+float IntersectRayBox(const glm::vec3& origin, const glm::vec3& inverseDirection, const glm::vec3& min, const glm::vec3& max, float maxDistance) {
+
+	glm::vec3 t0 = (min - origin) * inverseDirection;
+	glm::vec3 t1 = (max - origin) * inverseDirection;
+	glm::vec3 tNear = glm::min(t0, t1);
+	glm::vec3 tFar = glm::max(t0, t1);
+
+	float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.f));
+	float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+	return enter <= exit ? enter : FLT_MAX;
+}
+
+
+bool RaycastBvh(const Bvh& bvh, const std::vector<Bounds>& bounds, const glm::vec3& origin, const glm::vec3& direction,
+	std::uint32_t& hitItem, float& hitDistance) {
+
+	if (bvh.nodes.empty())
+		return false;
+
+	//Componentes nulas como un valor diminuto para que el inverso sea enorme pero finito (sin 0 * inf = NaN)
+	glm::vec3 inverseDirection;
+	for (int axis = 0; axis < 3; axis++)
+		inverseDirection[axis] = 1.f / (std::abs(direction[axis]) > 1e-30f ? direction[axis] : std::copysign(1e-30f, direction[axis]));
+
+	hitDistance = FLT_MAX;
+	bool hit = false;
+
+	std::uint32_t stack[BVH_MAX_DEPTH + 1];
+	int stackSize = 0;
+	if (IntersectRayBox(origin, inverseDirection, bvh.nodes[0].min, bvh.nodes[0].max, hitDistance) != FLT_MAX)
+		stack[stackSize++] = 0;
+
+	while (stackSize > 0) {
+		const BvhNode& node = bvh.nodes[stack[--stackSize]];
+
+		if (node.count > 0) {
+			for (std::uint32_t i = node.first; i < node.first + node.count; i++) {
+				const Bounds& item = bounds[bvh.items[i]];
+				float distance = IntersectRayBox(origin, inverseDirection, item.min, item.max, hitDistance);
+				if (distance < hitDistance) {
+					hitDistance = distance;
+					hitItem = bvh.items[i];
+					hit = true;
+				}
+			}
+			continue;
+		}
+
+		//Apilamos primero el hijo lejano para visitar antes el cercano y recortar mas con hitDistance
+		const BvhNode& left = bvh.nodes[node.first];
+		const BvhNode& right = bvh.nodes[node.first + 1];
+		float leftDistance = IntersectRayBox(origin, inverseDirection, left.min, left.max, hitDistance);
+		float rightDistance = IntersectRayBox(origin, inverseDirection, right.min, right.max, hitDistance);
+
+		std::uint32_t nearChild = node.first, farChild = node.first + 1;
+		if (rightDistance < leftDistance) {
+			std::swap(nearChild, farChild);
+			std::swap(leftDistance, rightDistance);
+		}
+		if (rightDistance != FLT_MAX && stackSize < BVH_MAX_DEPTH + 1)
+			stack[stackSize++] = farChild;
+		if (leftDistance != FLT_MAX && stackSize < BVH_MAX_DEPTH + 1)
+			stack[stackSize++] = nearChild;
+	}
+
+	return hit;
+}
+
+
+void QueryBvhFrustum(const Bvh& bvh, const std::vector<Bounds>& bounds, const Frustum& frustum, std::vector<std::uint32_t>& visible) {
+
+	if (bvh.nodes.empty())
+		return;
+
+	//Cada entrada lleva los planos que aun hay que probar: si un nodo esta entero dentro de un plano, sus hijos tambien
+	struct Entry
+	{
+		std::uint32_t node;
+		std::uint32_t planeMask;
+	};
+
+	Entry stack[BVH_MAX_DEPTH + 1];
+	int stackSize = 0;
+	stack[stackSize++] = Entry{ 0, (1u << 6) - 1 };
+
+	while (stackSize > 0) {
+		Entry entry = stack[--stackSize];
+		const BvhNode& node = bvh.nodes[entry.node];
+
+		glm::vec3 center = (node.min + node.max) * 0.5f;
+		glm::vec3 halfExtent = (node.max - node.min) * 0.5f;
+		bool outside = false;
+		for (int p = 0; p < 6 && !outside; p++) {
+			if ((entry.planeMask & (1u << p)) == 0)
+				continue;
+			glm::vec3 normal = glm::vec3(frustum.planes[p]);
+			float distance = glm::dot(normal, center) + frustum.planes[p].w;
+			float extent = glm::dot(glm::abs(normal), halfExtent);
+			if (distance < -extent)
+				outside = true;
+			else if (distance >= extent)
+				entry.planeMask &= ~(1u << p);
+		}
+		if (outside)
+			continue;
+
+		if (node.count > 0) {
+			for (std::uint32_t i = node.first; i < node.first + node.count; i++) {
+				std::uint32_t item = bvh.items[i];
+				bool itemVisible = true;
+				for (int p = 0; p < 6 && itemVisible; p++) {
+					if ((entry.planeMask & (1u << p)) == 0)
+						continue;
+					glm::vec3 normal = glm::vec3(frustum.planes[p]);
+					glm::vec3 itemCenter = (bounds[item].min + bounds[item].max) * 0.5f;
+					glm::vec3 itemHalfExtent = (bounds[item].max - bounds[item].min) * 0.5f;
+					itemVisible = glm::dot(normal, itemCenter) + frustum.planes[p].w >= -glm::dot(glm::abs(normal), itemHalfExtent);
+				}
+				if (itemVisible)
+					visible.push_back(item);
+			}
+			continue;
+		}
+
+		if (stackSize + 2 <= BVH_MAX_DEPTH + 1) {
+			stack[stackSize++] = Entry{ node.first + 1, entry.planeMask };
+			stack[stackSize++] = Entry{ node.first, entry.planeMask };
+		}
+	}
+}
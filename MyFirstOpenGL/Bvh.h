@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Culling.h"
+#include <glm.hpp>
+#include <cstdint>
+#include <vector>
+
+//Cubetas por eje al buscar el mejor corte con la heuristica de area (SAH)
+#define BVH_BINS 12
+
+//Elementos maximos por hoja; por debajo se corta solo si la SAH dice que sale a cuenta
+#define BVH_MAX_LEAF_SIZE 4
+
+//Profundidad maxima del arbol, que fija el tamano de la pila de los recorridos. Mas abajo los nodos se quedan como hoja
+#define BVH_MAX_DEPTH 64
+
+//Nodo de 32 bytes, dos por linea de cache. Los hijos de un nodo interior son contiguos (first y first + 1)
+//y siempre estan despues del padre en el array, asi que el refit puede recorrerlo al reves
+struct BvhNode
+{
+	glm::vec3 min;
+	std::uint32_t first; //Hoja: primer elemento en items. Interior: hijo izquierdo
+	glm::vec3 max;
+	std::uint32_t count; //Elementos de la hoja, 0 en los nodos interiores
+};
+
+static_assert(sizeof(BvhNode) == 32, "BvhNode debe ocupar media linea de cache");
+
+//Jerarquia de volumenes sobre las cajas (min, max) de los objetos. items guarda los indices de los objetos
+//ordenados por hojas; las cajas las mantiene quien llama y se vuelven a pasar en cada refit o consulta
+struct Bvh
+{
+	std::vector<BvhNode> nodes;
+	std::vector<std::uint32_t> items;
+
+	//Coste SAH justo despues de construir. Si tras varios refits crece mucho conviene reconstruir
+	float builtCost = 0.f;
+};
+
+void BuildBvh(Bvh& bvh, const std::vector<Bounds>& bounds);
+
+//Recalcula las cajas de todos los nodos sin cambiar la topologia, en tiempo lineal
+void RefitBvh(Bvh& bvh, const std::vector<Bounds>& bounds);
+
+//Coste SAH del arbol relativo al area de la raiz (nodos interiores 1, cada elemento de hoja 1)
+float ComputeBvhCost(const Bvh& bvh);
+
+//Elemento cuya caja corta primero el rayo. direction no hace falta normalizarla; hitDistance va en unidades de direction
+bool RaycastBvh(const Bvh& bvh, const std::vector<Bounds>& bounds, const glm::vec3& origin, const glm::vec3& direction,
+	std::uint32_t& hitItem, float& hitDistance);
+
+//Anade a visible los elementos cuya caja toca el frustum. Los subarboles enteros dentro no se vuelven a probar
+void QueryBvhFrustum(const Bvh& bvh, const std::vector<Bounds>& bounds, const Frustum& frustum, std::vector<std::uint32_t>& visible);
@@ -0,0 +1,46 @@
+#include "Camera.h"
+#include <gtc/matrix_transform.hpp>
+
+
+glm::mat4 CameraView(const Camera& camera) {
+
+	return glm::lookAt(camera.position, camera.target, camera.up);
+}
+
+
+glm::mat4 CameraProjection(const Camera& camera) {
+
+	if (camera.perspective)
+		return glm::perspective(glm::radians(camera.fieldOfView), camera.aspect, camera.nearPlane, camera.farPlane);
+
+	float halfWidth = camera.halfHeight * camera.aspect;
+	return glm::ortho(-halfWidth, halfWidth, -camera.halfHeight, camera.halfHeight, camera.nearPlane, camera.farPlane);
+}
+
+
+glm::mat4 CameraViewProjection(const Camera& camera) {
+
+	return CameraProjection(camera) * CameraView(camera);
+}
+
+
+float ProjectedDepth(const glm::mat4& viewProjection, const glm::vec3& position) {
+
+	//Detras de la camara (w <= 0) se queda en el plano cercano
+	glm::vec4 clip = viewProjection * glm::vec4(position, 1.f);
+	if (clip.w <= 0.f)
+		return 0.f;
+
+	return glm::clamp(clip.z / clip.w * 0.5f + 0.5f, 0.f, 1.f);
+}
+
+
+void CameraRay(const Camera& camera, const glm::vec2& ndc, glm::vec3& origin, glm::vec3& direction) {
+
+	glm::mat4 inverseViewProjection = glm::inverse(CameraViewProjection(camera));
+	glm::vec4 nearPoint = inverseViewProjection * glm::vec4(ndc, -1.f, 1.f);
+	glm::vec4 farPoint = inverseViewProjection * glm::vec4(ndc, 1.f, 1.f);
+
+	origin = glm::vec3(nearPoint) / nearPoint.w;
+	direction = glm::vec3(farPoint) / farPoint.w - origin;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <glm.hpp>
+
+//Camara de la escena. Por defecto es ortografica y cubre el cubo [-1, 1] que antes los shaders
+//escribian directamente como NDC, asi que la escena se ve igual que sin camara
+struct Camera
+{
+	glm::vec3 position = glm::vec3(0.f);
+	glm::vec3 target = glm::vec3(0.f, 0.f, -1.f);
+	glm::vec3 up = glm::vec3(0.f, 1.f, 0.f);
+
+	bool perspective = false;
+
+	//Perspectiva: campo de vision vertical en grados
+	float fieldOfView = 60.f;
+
+	//Ortografica: mitad de la altura visible. La anchura es halfHeight * aspect
+	float halfHeight = 1.f;
+
+	float aspect = 1.f;
+	float nearPlane = -1.f;
+	float farPlane = 1.f;
+};
+
+glm::mat4 CameraView(const Camera& camera);
+
+glm::mat4 CameraProjection(const Camera& camera);
+
+glm::mat4 CameraViewProjection(const Camera& camera);
+
+//Profundidad de un punto en [0, 1] (0 en el plano cercano) con la matriz proyeccion * vista, para ordenar draws
+float ProjectedDepth(const glm::mat4& viewProjection, const glm::vec3& position);
+
+//Rayo desde la camara que pasa por un punto de la pantalla en NDC ([-1, 1], y hacia arriba). direction va del plano
+//cercano al lejano sin normalizar, asi que las distancias a lo largo del rayo van de 0 a 1 dentro del frustum
+void CameraRay(const Camera& camera, const glm::vec2& ndc, glm::vec3& origin, glm::vec3& direction);
@@ -0,0 +1,340 @@
+#include "Culling.h"
+#include <simd/common.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#if GLM_ARCH & GLM_ARCH_AVX_BIT
+#include <immintrin.h>
+#endif
+
+
+Bounds ComputeBounds(const void* positions, size_t count, size_t stride) {
+
+	Bounds bounds;
+	if (count == 0)
+		return bounds;
+
+	const unsigned char* bytes = static_cast<const unsigned char*>(positions);
+	glm::vec3 position;
+
+	std::memcpy(&position, bytes, sizeof(glm::vec3));
+	bounds.min = position;
+	bounds.max = position;
+	for (size_t i = 1; i < count; i++) {
+		std::memcpy(&position, bytes + i * stride, sizeof(glm::vec3));
+		bounds.min = glm::min(bounds.min, position);
+		bounds.max = glm::max(bounds.max, position);
+	}
+
+	//Esfera centrada en la caja; el radio es la distancia al vertice mas lejano, no a la esquina de la caja
+	bounds.center = (bounds.min + bounds.max) * 0.5f;
+	float radiusSquared = 0.f;
+	for (size_t i = 0; i < count; i++) {
+		std::memcpy(&position, bytes + i * stride, sizeof(glm::vec3));
+		glm::vec3 offset = position - bounds.center;
+		radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+	}
+	bounds.radius = std::sqrt(radiusSquared);
+
+	return bounds;
+}
+
+
+Frustum ExtractFrustum(const glm::mat4& viewProjection) {
+
+	//Filas de la matriz (glm guarda columnas)
+	glm::vec4 rows[4];
+	for (int row = 0; row < 4; row++)
+		rows[row] = glm::vec4(viewProjection[0][row], viewProjection[1][row], viewProjection[2][row], viewProjection[3][row]);
+
+	Frustum frustum;
+	frustum.planes[0] = rows[3] + rows[0]; //Izquierda
+	frustum.planes[1] = rows[3] - rows[0]; //Derecha
+	frustum.planes[2] = rows[3] + rows[1]; //Abajo
+	frustum.planes[3] = rows[3] - rows[1]; //Arriba
+	frustum.planes[4] = rows[3] + rows[2]; //Cerca
+	frustum.planes[5] = rows[3] - rows[2]; //Lejos
+
+	//Normalizados para que la distancia al plano se pueda comparar con el radio
+	for (glm::vec4& plane : frustum.planes)
+		plane /= glm::length(glm::vec3(plane));
+
+	return frustum;
+}
+
+
+void TransformSphere(const Bounds& bounds, const glm::mat4& modelMatrix, glm::vec3& center, float& radius) {
+
+	center = glm::vec3(modelMatrix * glm::vec4(bounds.center, 1.f));
+
+	float scaleSquared = std::max(glm::dot(glm::vec3(modelMatrix[0]), glm::vec3(modelMatrix[0])),
+		std::max(glm::dot(glm::vec3(modelMatrix[1]), glm::vec3(modelMatrix[1])), glm::dot(glm::vec3(modelMatrix[2]), glm::vec3(modelMatrix[2]))));
+	radius = bounds.radius * std::sqrt(scaleSquared);
+}
+
+
+Bounds TransformBounds(const Bounds& bounds, const glm::mat4& modelMatrix) {
+
+	//Centro transformado y semiejes proyectados en valor absoluto sobre cada eje de mundo (Arvo)
+	glm::vec3 center = glm::vec3(modelMatrix * glm::vec4((bounds.min + bounds.max) * 0.5f, 1.f));
+	glm::vec3 halfExtent = (bounds.max - bounds.min) * 0.5f;
+	glm::vec3 worldExtent = glm::abs(glm::vec3(modelMatrix[0])) * halfExtent.x + glm::abs(glm::vec3(modelMatrix[1])) * halfExtent.y
+		+ glm::abs(glm::vec3(modelMatrix[2])) * halfExtent.z;
+
+	Bounds world;
+	world.min = center - worldExtent;
+	world.max = center + worldExtent;
+	TransformSphere(bounds, modelMatrix, world.center, world.radius);
+	return world;
+}
+
+
+bool IsSphereVisible(const Frustum& frustum, const glm::vec3& center, float radius) {
+
+	for (const glm::vec4& plane : frustum.planes)
+		if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+			return false;
+	return true;
+}
+
+
+bool IsSphereNearFrustumBoundary(const Frustum& frustum, const glm::vec3& center, float radius, float epsilon) {
+
+	for (const glm::vec4& plane : frustum.planes)
+		if (std::abs(glm::dot(glm::vec3(plane), center) + plane.w + radius) <= epsilon)
+			return true;
+	return false;
+}
+
+
+bool IsBoxVisible(const Frustum& frustum, const Bounds& bounds, const glm::mat4& modelMatrix) {
+
+	glm::vec3 center = glm::vec3(modelMatrix * glm::vec4((bounds.min + bounds.max) * 0.5f, 1.f));
+	glm::vec3 halfExtent = (bounds.max - bounds.min) * 0.5f;
+
+	//Proyectamos la caja orientada sobre la normal de cada plano: el radio efectivo es la suma de sus tres ejes
+	for (const glm::vec4& plane : frustum.planes) {
+		glm::vec3 normal = glm::vec3(plane);
+		float extent = std::abs(glm::dot(normal, glm::vec3(modelMatrix[0]))) * halfExtent.x
+			+ std::abs(glm::dot(normal, glm::vec3(modelMatrix[1]))) * halfExtent.y
+			+ std::abs(glm::dot(normal, glm::vec3(modelMatrix[2]))) * halfExtent.z;
+		if (glm::dot(normal, center) + plane.w < -extent)
+			return false;
+	}
+	return true;
+}
+
+
+void ResizeSphereArray(SphereArray& spheres, size_t count) {
+
+	spheres.centerX.resize(count);
+	spheres.centerY.resize(count);
+	spheres.centerZ.resize(count);
+	spheres.radius.resize(count);
+}
+
+
+size_t CullRangeScalar(const Frustum& frustum, const SphereArray& spheres, size_t begin, size_t end, std::uint32_t* visible, size_t& visibleCount) {
+
+	for (size_t i = begin; i < end; i++) {
+		glm::vec3 center(spheres.centerX[i], spheres.centerY[i], spheres.centerZ[i]);
+		visible[visibleCount] = static_cast<std::uint32_t>(i);
+		visibleCount += IsSphereVisible(frustum, center, spheres.radius[i]) ? 1 : 0;
+	}
+	return end;
+}
+
+
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+
+//4 esferas por iteracion: distancia a cada plano con los helpers glm_vec4 y mascara de las que quedan dentro
+size_t CullRangeSSE(const Frustum& frustum, const SphereArray& spheres, size_t begin, size_t end, std::uint32_t* visible, size_t& visibleCount) {
+
+	glm_vec4 planeX[6], planeY[6], planeZ[6], planeW[6];
+	for (int p = 0; p < 6; p++) {
+		planeX[p] = _mm_set1_ps(frustum.planes[p].x);
+		planeY[p] = _mm_set1_ps(frustum.planes[p].y);
+		planeZ[p] = _mm_set1_ps(frustum.planes[p].z);
+		planeW[p] = _mm_set1_ps(frustum.planes[p].w);
+	}
+	glm_vec4 const signBit = _mm_set1_ps(-0.f);
+
+	size_t i = begin;
+	for (; i + 4 <= end; i += 4) {
+
+		glm_vec4 const x = _mm_loadu_ps(spheres.centerX.data() + i);
+		glm_vec4 const y = _mm_loadu_ps(spheres.centerY.data() + i);
+		glm_vec4 const z = _mm_loadu_ps(spheres.centerZ.data() + i);
+		glm_vec4 const negativeRadius = _mm_xor_ps(_mm_loadu_ps(spheres.radius.data() + i), signBit);
+
+		glm_vec4 inside = _mm_cmpeq_ps(x, x);
+		for (int p = 0; p < 6; p++) {
+			glm_vec4 const distance = glm_vec4_fma(x, planeX[p], glm_vec4_fma(y, planeY[p], glm_vec4_fma(z, planeZ[p], planeW[p])));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+		}
+
+		//Compactamos sin saltos: se escribe siempre y solo se avanza si la lane es visible
+		int mask = _mm_movemask_ps(inside);
+		for (int lane = 0; lane < 4; lane++) {
+			visible[visibleCount] = static_cast<std::uint32_t>(i + lane);
+			visibleCount += (mask >> lane) & 1;
+		}
+	}
+
+	return i;
+}
+
+#endif
+
+
+#if GLM_ARCH & GLM_ARCH_AVX_BIT
+
+//Misma logica que la version SSE con 8 esferas por iteracion
+size_t CullRangeAVX(const Frustum& frustum, const SphereArray& spheres, size_t begin, size_t end, std::uint32_t* visible, size_t& visibleCount) {
+
+	__m256 planeX[6], planeY[6], planeZ[6], planeW[6];
+	for (int p = 0; p < 6; p++) {
+		planeX[p] = _mm256_set1_ps(frustum.planes[p].x);
+		planeY[p] = _mm256_set1_ps(frustum.planes[p].y);
+		planeZ[p] = _mm256_set1_ps(frustum.planes[p].z);
+		planeW[p] = _mm256_set1_ps(frustum.planes[p].w);
+	}
+	__m256 const signBit = _mm256_set1_ps(-0.f);
+
+	size_t i = begin;
+	for (; i + 8 <= end; i += 8) {
+
+		__m256 const x = _mm256_loadu_ps(spheres.centerX.data() + i);
+		__m256 const y = _mm256_loadu_ps(spheres.centerY.data() + i);
+		__m256 const z = _mm256_loadu_ps(spheres.centerZ.data() + i);
+		__m256 const negativeRadius = _mm256_xor_ps(_mm256_loadu_ps(spheres.radius.data() + i), signBit);
+
+		__m256 inside = _mm256_cmp_ps(x, x, _CMP_EQ_OQ);
+		for (int p = 0; p < 6; p++) {
+#if GLM_ARCH & GLM_ARCH_AVX2_BIT
+			__m256 const distance = _mm256_fmadd_ps(x, planeX[p], _mm256_fmadd_ps(y, planeY[p], _mm256_fmadd_ps(z, planeZ[p], planeW[p])));
+#else
+			__m256 const distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, planeX[p]), _mm256_mul_ps(y, planeY[p])),
+				_mm256_add_ps(_mm256_mul_ps(z, planeZ[p]), planeW[p]));
+#endif
+			inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+		}
+
+		int mask = _mm256_movemask_ps(inside);
+		for (int lane = 0; lane < 8; lane++) {
+			visible[visibleCount] = static_cast<std::uint32_t>(i + lane);
+			visibleCount += (mask >> lane) & 1;
+		}
+	}
+
+	return i;
+}
+
+#endif
+
+
+size_t CullSpheres(const Frustum& frustum, const SphereArray& spheres, size_t begin, size_t end, std::uint32_t* visible) {
+
+	//Cada version vectorial procesa los lotes completos que puede y devuelve donde se ha quedado
+	size_t visibleCount = 0;
+	size_t i = begin;
+#if GLM_ARCH & GLM_ARCH_AVX_BIT
+	i = CullRangeAVX(frustum, spheres, i, end, visible, visibleCount);
+#endif
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+	i = CullRangeSSE(frustum, spheres, i, end, visible, visibleCount);
+#endif
+	CullRangeScalar(frustum, spheres, i, end, visible, visibleCount);
+	return visibleCount;
+}
+
+
+size_t CullSpheresScalar(const Frustum& frustum, const SphereArray& spheres, size_t begin, size_t end, std::uint32_t* visible) {
+
+	size_t visibleCount = 0;
+	CullRangeScalar(frustum, spheres, begin, end, visible, visibleCount);
+	return visibleCount;
+}
+
+
+void BuildHiZBuffer(HiZBuffer& hiZ, const float* depth, int width, int height) {
+
+	hiZ.levels.clear();
+	hiZ.widths.clear();
+	hiZ.heights.clear();
+	if (width <= 0 || height <= 0)
+		return;
+
+	hiZ.levels.emplace_back(depth, depth + static_cast<size_t>(width) * height);
+	hiZ.widths.push_back(width);
+	hiZ.heights.push_back(height);
+
+	//Cada nivel mide la mitad redondeando hacia arriba; en bordes impares el texel de mas se repite
+	while (width > 1 || height > 1) {
+		int nextWidth = (width + 1) / 2;
+		int nextHeight = (height + 1) / 2;
+		const std::vector<float>& source = hiZ.levels.back();
+		std::vector<float> level(static_cast<size_t>(nextWidth) * nextHeight);
+
+		for (int y = 0; y < nextHeight; y++) {
+			int y0 = y * 2, y1 = std::min(y * 2 + 1, height - 1);
+			for (int x = 0; x < nextWidth; x++) {
+				int x0 = x * 2, x1 = std::min(x * 2 + 1, width - 1);
+				level[static_cast<size_t>(y) * nextWidth + x] = std::max(
+					std::max(source[static_cast<size_t>(y0) * width + x0], source[static_cast<size_t>(y0) * width + x1]),
+					std::max(source[static_cast<size_t>(y1) * width + x0], source[static_cast<size_t>(y1) * width + x1]));
+			}
+		}
+
+		hiZ.levels.push_back(std::move(level));
+		hiZ.widths.push_back(nextWidth);
+		hiZ.heights.push_back(nextHeight);
+		width = nextWidth;
+		height = nextHeight;
+	}
+}
+
+
+bool IsSphereUnoccluded(const HiZBuffer& hiZ, const glm::mat4& viewProjection, const glm::vec3& center, float radius) {
+
+	if (hiZ.levels.empty())
+		return true;
+
+	//Rectangulo en pantalla y profundidad mas cercana de la caja que envuelve la esfera
+	glm::vec2 minimum(FLT_MAX), maximum(-FLT_MAX);
+	float nearestDepth = 1.f;
+	for (int corner = 0; corner < 8; corner++) {
+		glm::vec3 offset((corner & 1) ? radius : -radius, (corner & 2) ? radius : -radius, (corner & 4) ? radius : -radius);
+		glm::vec4 clip = viewProjection * glm::vec4(center + offset, 1.f);
+		if (clip.w <= 0.f)
+			return true;
+
+		glm::vec3 ndc = glm::vec3(clip) / clip.w;
+		minimum = glm::min(minimum, glm::vec2(ndc));
+		maximum = glm::max(maximum, glm::vec2(ndc));
+		nearestDepth = std::min(nearestDepth, ndc.z * 0.5f + 0.5f);
+	}
+
+	//Lo que queda fuera de la pantalla ya lo descarta el frustum
+	minimum = glm::clamp(minimum, glm::vec2(-1.f), glm::vec2(1.f));
+	maximum = glm::clamp(maximum, glm::vec2(-1.f), glm::vec2(1.f));
+	float x0 = (minimum.x * 0.5f + 0.5f) * hiZ.widths[0], x1 = (maximum.x * 0.5f + 0.5f) * hiZ.widths[0];
+	float y0 = (minimum.y * 0.5f + 0.5f) * hiZ.heights[0], y1 = (maximum.y * 0.5f + 0.5f) * hiZ.heights[0];
+
+	//Nivel en el que el rectangulo ocupa como mucho 2x2 texels
+	float size = std::max(std::max(x1 - x0, y1 - y0), 1.f);
+	int level = std::min(static_cast<int>(std::ceil(std::log2(size))), static_cast<int>(hiZ.levels.size()) - 1);
+
+	int levelWidth = hiZ.widths[level], levelHeight = hiZ.heights[level];
+	int tx0 = std::min(static_cast<int>(x0) >> level, levelWidth - 1), tx1 = std::min(static_cast<int>(x1) >> level, levelWidth - 1);
+	int ty0 = std::min(static_cast<int>(y0) >> level, levelHeight - 1), ty1 = std::min(static_cast<int>(y1) >> level, levelHeight - 1);
+
+	float farthestDepth = 0.f;
+	for (int y = ty0; y <= ty1; y++)
+		for (int x = tx0; x <= tx1; x++)
+			farthestDepth = std::max(farthestDepth, hiZ.levels[level][static_cast<size_t>(y) * levelWidth + x]);
+
+	return nearestDepth <= farthestDepth;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//Objetos que procesa cada trabajo del culling. Multiplo de 8 para que los lotes AVX no se partan
+#define CULL_JOB_GRAIN 4096
+
+//Caja alineada con los ejes y esfera que envuelven una malla en espacio local
+struct Bounds
+{
+	glm::vec3 min = glm::vec3(0.f);
+	glm::vec3 max = glm::vec3(0.f);
+	glm::vec3 center = glm::vec3(0.f);
+	float radius = 0.f;
+};
+
+//Planos (a, b, c, d) normalizados y mirando hacia dentro: un punto esta dentro si a*x + b*y + c*z + d >= 0 en los seis
+struct Frustum
+{
+	glm::vec4 planes[6];
+};
+
+//Esferas en espacio de mundo como estructura de arrays, para probarlas de 4 en 4 (SSE) u 8 en 8 (AVX)
+struct SphereArray
+{
+	std::vector<float> centerX, centerY, centerZ, radius;
+};
+
+//Piramide de profundidad para oclusion (Hi-Z). Cada texel de un nivel guarda la profundidad mas lejana
+//de los 2x2 del nivel anterior; el nivel 0 es el depth buffer en coordenadas de ventana [0, 1]
+struct HiZBuffer
+{
+	std::vector<std::vector<float>> levels;
+	std::vector<int> widths, heights;
+};
+
+//Caja y esfera de count posiciones vec3 separadas stride bytes
+Bounds ComputeBounds(const void* positions, size_t count, size_t stride);
+
+//Planos de la matriz proyeccion * vista (Gribb-Hartmann)
+Frustum ExtractFrustum(const glm::mat4& viewProjection);
+
+//Caja alineada y esfera en espacio de mundo de unos bounds locales transformados por una matriz de modelo
+Bounds TransformBounds(const Bounds& bounds, const glm::mat4& modelMatrix);
+
+//Esfera de los bounds en espacio de mundo. El radio se escala con el eje mas estirado de la matriz
+void TransformSphere(const Bounds& bounds, const glm::mat4& modelMatrix, glm::vec3& center, float& radius);
+
+bool IsSphereVisible(const Frustum& frustum, const glm::vec3& center, float radius);
+
+//True si la esfera queda a menos de epsilon de tocar o dejar de tocar algun plano: ahi otro calculo con
+//distinto redondeo (p.ej. en la GPU) puede dar el resultado contrario
+bool IsSphereNearFrustumBoundary(const Frustum& frustum, const glm::vec3& center, float radius, float epsilon);
+
+//Prueba la caja transformada, mas ajustada que la esfera para objetos alargados
+bool IsBoxVisible(const Frustum& frustum, const Bounds& bounds, const glm::mat4& modelMatrix);
+
+void ResizeSphereArray(SphereArray& spheres, size_t count);
+
+inline void SetSphere(SphereArray& spheres, size_t index, const glm::vec3& center, float radius)
+{
+	spheres.centerX[index] = center.x;
+	spheres.centerY[index] = center.y;
+	spheres.centerZ[index] = center.z;
+	spheres.radius[index] = radius;
+}
+
+//Prueba las esferas [begin, end) contra el frustum por lotes SSE/AVX y escribe en visible los indices de las que
+//lo tocan, en orden. visible debe tener sitio para end - begin indices. Devuelve cuantos ha escrito
+size_t CullSpheres(const Frustum& frustum, const SphereArray& spheres, size_t begin, size_t end, std::uint32_t* visible);
+
+//Misma prueba esfera a esfera, como referencia para el benchmark
+size_t CullSpheresScalar(const Frustum& frustum, const SphereArray& spheres, size_t begin, size_t end, std::uint32_t* visible);
+
+//Construye la piramide a partir de un depth buffer de width x height (p.ej. el del frame anterior leido con glReadPixels)
+void BuildHiZBuffer(HiZBuffer& hiZ, const float* depth, int width, int height);
+
+//false solo si la esfera queda entera detras de lo ya dibujado. Es conservadora: si cruza el plano cercano se da por visible
+bool IsSphereUnoccluded(const HiZBuffer& hiZ, const glm::mat4& viewProjection, const glm::vec3& center, float radius);
@@ -0,0 +1,60 @@
+#version 440 core
+
+//GPU_CULL_GROUP_SIZE objetos por grupo de trabajo
+layout(local_size_x = 64) in;
+
+//Mismo layout que DrawElementsIndirectCommand
+struct DrawCommand
+{
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+//Matrices de modelo de todos los objetos candidatos
+layout(std430, binding = 2) readonly buffer CullObjects
+{
+    mat4 objectMatrices[];
+};
+
+//Matrices de los que pasan, compactadas al principio
+layout(std430, binding = 3) writeonly buffer VisibleTransforms
+{
+    mat4 visibleMatrices[];
+};
+
+//Comando del draw indirecto; instanceCount hace de contador atomico
+layout(std430, binding = 4) buffer CullCommand
+{
+    DrawCommand command;
+};
+
+//Planos del frustum, esfera local de la malla (centro y radio) y numero de objetos
+layout(location = 0) uniform vec4 frustumPlanes[6];
+layout(location = 6) uniform vec4 localSphere;
+layout(location = 7) uniform uint objectCount;
+
+
+void main()
+{
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= objectCount)
+        return;
+
+    //Igual que TransformSphere: el radio crece con el eje mas estirado de la matriz
+    mat4 modelMatrix = objectMatrices[index];
+    vec3 center = (modelMatrix * vec4(localSphere.xyz, 1.0)).xyz;
+    float scaleSquared = max(dot(modelMatrix[0].xyz, modelMatrix[0].xyz),
+        max(dot(modelMatrix[1].xyz, modelMatrix[1].xyz), dot(modelMatrix[2].xyz, modelMatrix[2].xyz)));
+    float radius = localSphere.w * sqrt(scaleSquared);
+
+    for (int i = 0; i < 6; i++) {
+        if (dot(frustumPlanes[i].xyz, center) + frustumPlanes[i].w < -radius)
+            return;
+    }
+
+    uint slot = atomicAdd(command.instanceCount, 1u);
+    visibleMatrices[slot] = modelMatrix;
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+#include "File.h"
+#include <iostream>
+#include <fstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+bool Load_File(const std::string& filePath, std::string& fileContent) {
+
+	std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+
+	//Devolvemos error si el archivo no se ha podido abrir
+	if (!file.is_open()) {
+		std::cerr << "No se ha podido abrir el archivo: " << filePath << std::endl;
+		return false;
+	}
+
+	//Reservamos el tamano exacto una sola vez y leemos todo el archivo en una unica llamada
+	fileContent.assign(static_cast<size_t>(file.tellg()), '\0');
+	file.seekg(0);
+	file.read(&fileContent[0], fileContent.size());
+
+	return static_cast<bool>(file);
+}
+
+
+bool MapFile(const std::string& filePath, FileView& view) {
+
+	view = FileView();
+
+#ifdef _WIN32
+	HANDLE fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize)) {
+		CloseHandle(fileHandle);
+		return false;
+	}
+	view.fileHandle = fileHandle;
+	view.size = static_cast<size_t>(fileSize.QuadPart);
+
+	//Un archivo vacio no se puede mapear, devolvemos una vista vacia
+	if (view.size > 0) {
+		view.mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		view.data = static_cast<const char*>(MapViewOfFile(view.mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	}
+#else
+	int fileDescriptor = open(filePath.c_str(), O_RDONLY);
+	if (fileDescriptor < 0)
+		return false;
+
+	struct stat fileStatus;
+	if (fstat(fileDescriptor, &fileStatus) != 0) {
+		close(fileDescriptor);
+		return false;
+	}
+	view.size = static_cast<size_t>(fileStatus.st_size);
+
+	//Un archivo vacio no se puede mapear, devolvemos una vista vacia
+	if (view.size > 0) {
+		void* mapped = mmap(nullptr, view.size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+		if (mapped != MAP_FAILED) {
+			madvise(mapped, view.size, MADV_SEQUENTIAL);
+			view.data = static_cast<const char*>(mapped);
+		}
+	}
+
+	//El mapeo se mantiene aunque cerremos el descriptor
+	close(fileDescriptor);
+#endif
+
+	//Si el mapeo ha fallado liberamos lo que se haya abierto
+	if (view.size > 0 && view.data == nullptr) {
+		std::cerr << "No se ha podido mapear el archivo: " << filePath << std::endl;
+		UnmapFile(view);
+		return false;
+	}
+
+	return true;
+}
+
+
+void UnmapFile(FileView& file) {
+
+#ifdef _WIN32
+	if (file.data != nullptr)
+		UnmapViewOfFile(file.data);
+	if (file.mappingHandle != nullptr)
+		CloseHandle(file.mappingHandle);
+	if (file.fileHandle != nullptr)
+		CloseHandle(file.fileHandle);
+
+	file.fileHandle = nullptr;
+	file.mappingHandle = nullptr;
+#else
+	if (file.data != nullptr)
+		munmap(const_cast<char*>(file.data), file.size);
+#endif
+
+	file.data = nullptr;
+	file.size = 0;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+//Vista de solo lectura sobre un archivo mapeado en memoria.
+//El contenido no se copia: data apunta directamente a las paginas del archivo
+struct FileView
+{
+	const char* data = nullptr;
+	size_t size = 0;
+
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#endif
+};
+
+//Ambas devuelven false si el archivo no se puede leer, sin cerrar la aplicacion
+bool Load_File(const std::string& filePath, std::string& fileContent);
+
+bool MapFile(const std::string& filePath, FileView& view);
+
+void UnmapFile(FileView& file);
+
+inline std::string_view ViewOf(const FileView& file)
+{
+	return std::string_view(file.data, file.size);
+}
@@ -0,0 +1,327 @@
+#include "GameObjects.h"
+#include <simd/common.h>
+
+#if GLM_ARCH & GLM_ARCH_AVX_BIT
+#include <immintrin.h>
+#endif
+
+
+GameObjectArray CreateGameObjectArray(MovedComponent movedComponent, float bounceMin, float bounceMax, size_t capacity) {
+
+	GameObjectArray objects;
+	objects.movedComponent = movedComponent;
+	objects.bounceMin = bounceMin;
+	objects.bounceMax = bounceMax;
+
+	for (std::vector<float>* component : {
+		&objects.positionX, &objects.positionY, &objects.positionZ,
+		&objects.rotationX, &objects.rotationY, &objects.rotationZ,
+		&objects.scaleX, &objects.scaleY, &objects.scaleZ,
+		&objects.forwardX, &objects.forwardY, &objects.forwardZ,
+		&objects.forwardRotationX, &objects.forwardRotationY, &objects.forwardRotationZ,
+		&objects.velocity, &objects.angularVelocity,
+		&objects.previousMovedX, &objects.previousMovedY, &objects.previousMovedZ,
+		&objects.previousRotationX, &objects.previousRotationY, &objects.previousRotationZ })
+		component->reserve(capacity);
+
+	return objects;
+}
+
+
+size_t AddGameObject(GameObjectArray& objects, const GameObject& object) {
+
+	objects.positionX.push_back(object.position.x);
+	objects.positionY.push_back(object.position.y);
+	objects.positionZ.push_back(object.position.z);
+	objects.rotationX.push_back(object.rotation.x);
+	objects.rotationY.push_back(object.rotation.y);
+	objects.rotationZ.push_back(object.rotation.z);
+	objects.scaleX.push_back(object.scale.x);
+	objects.scaleY.push_back(object.scale.y);
+	objects.scaleZ.push_back(object.scale.z);
+	objects.forwardX.push_back(object.forward.x);
+	objects.forwardY.push_back(object.forward.y);
+	objects.forwardZ.push_back(object.forward.z);
+	objects.forwardRotationX.push_back(object.forwardRotation.x);
+	objects.forwardRotationY.push_back(object.forwardRotation.y);
+	objects.forwardRotationZ.push_back(object.forwardRotation.z);
+	objects.velocity.push_back(object.velocity);
+	objects.angularVelocity.push_back(object.angularVelocity);
+
+	//El primer frame se dibuja con el estado inicial, sin interpolar desde valores por defecto
+	glm::vec3 moved = objects.movedComponent == MOVE_POSITION ? object.position : object.scale;
+	objects.previousMovedX.push_back(moved.x);
+	objects.previousMovedY.push_back(moved.y);
+	objects.previousMovedZ.push_back(moved.z);
+	objects.previousRotationX.push_back(object.rotation.x);
+	objects.previousRotationY.push_back(object.rotation.y);
+	objects.previousRotationZ.push_back(object.rotation.z);
+
+	return objects.count++;
+}
+
+
+GameObject GetGameObject(const GameObjectArray& objects, size_t index) {
+
+	GameObject object;
+	object.position = glm::vec3(objects.positionX[index], objects.positionY[index], objects.positionZ[index]);
+	object.rotation = glm::vec3(objects.rotationX[index], objects.rotationY[index], objects.rotationZ[index]);
+	object.scale = glm::vec3(objects.scaleX[index], objects.scaleY[index], objects.scaleZ[index]);
+	object.forward = glm::vec3(objects.forwardX[index], objects.forwardY[index], objects.forwardZ[index]);
+	object.forwardRotation = glm::vec3(objects.forwardRotationX[index], objects.forwardRotationY[index], objects.forwardRotationZ[index]);
+	object.velocity = objects.velocity[index];
+	object.angularVelocity = objects.angularVelocity[index];
+	return object;
+}
+
+
+GameObject InterpolateGameObject(const GameObjectArray& objects, size_t index, float alpha) {
+
+	GameObject object = GetGameObject(objects, index);
+
+	glm::vec3 previousMoved = glm::vec3(objects.previousMovedX[index], objects.previousMovedY[index], objects.previousMovedZ[index]);
+	glm::vec3 previousRotation = glm::vec3(objects.previousRotationX[index], objects.previousRotationY[index], objects.previousRotationZ[index]);
+
+	if (objects.movedComponent == MOVE_POSITION)
+		object.position = glm::mix(previousMoved, object.position, alpha);
+	else
+		object.scale = glm::mix(previousMoved, object.scale, alpha);
+	object.rotation = glm::mix(previousRotation, object.rotation, alpha);
+
+	return object;
+}
+
+
+void ScaleGameObjectVelocity(GameObjectArray& objects, size_t index, float factor) {
+
+	objects.velocity[index] *= factor;
+	objects.angularVelocity[index] *= factor;
+}
+
+
+//Punteros a los arrays que lee y escribe el paso de simulacion
+struct SimulationArrays
+{
+	float* movedX;
+	float* movedY;
+	float* movedZ;
+	float* rotationX;
+	float* rotationY;
+	float* rotationZ;
+	const float* forwardRotationX;
+	const float* forwardRotationY;
+	const float* forwardRotationZ;
+	float* forwardX;
+	float* forwardY;
+	float* forwardZ;
+	const float* velocity;
+	const float* angularVelocity;
+	float* previousMovedX;
+	float* previousMovedY;
+	float* previousMovedZ;
+	float* previousRotationX;
+	float* previousRotationY;
+	float* previousRotationZ;
+};
+
+
+SimulationArrays GetSimulationArrays(GameObjectArray& objects) {
+
+	bool movesPosition = objects.movedComponent == MOVE_POSITION;
+
+	SimulationArrays arrays;
+	arrays.movedX = movesPosition ? objects.positionX.data() : objects.scaleX.data();
+	arrays.movedY = movesPosition ? objects.positionY.data() : objects.scaleY.data();
+	arrays.movedZ = movesPosition ? objects.positionZ.data() : objects.scaleZ.data();
+	arrays.rotationX = objects.rotationX.data();
+	arrays.rotationY = objects.rotationY.data();
+	arrays.rotationZ = objects.rotationZ.data();
+	arrays.forwardRotationX = objects.forwardRotationX.data();
+	arrays.forwardRotationY = objects.forwardRotationY.data();
+	arrays.forwardRotationZ = objects.forwardRotationZ.data();
+	arrays.forwardX = objects.forwardX.data();
+	arrays.forwardY = objects.forwardY.data();
+	arrays.forwardZ = objects.forwardZ.data();
+	arrays.velocity = objects.velocity.data();
+	arrays.angularVelocity = objects.angularVelocity.data();
+	arrays.previousMovedX = objects.previousMovedX.data();
+	arrays.previousMovedY = objects.previousMovedY.data();
+	arrays.previousMovedZ = objects.previousMovedZ.data();
+	arrays.previousRotationX = objects.previousRotationX.data();
+	arrays.previousRotationY = objects.previousRotationY.data();
+	arrays.previousRotationZ = objects.previousRotationZ.data();
+	return arrays;
+}
+
+
+//Paso de simulacion de los objetos [begin, end) de uno en uno.
+//El estado anterior se guarda en la misma pasada para no recorrer la memoria dos veces
+void SimulateRangeScalar(SimulationArrays& arrays, size_t begin, size_t end, float bounceMin, float bounceMax) {
+
+	for (size_t i = begin; i < end; i++) {
+
+		arrays.previousMovedX[i] = arrays.movedX[i];
+		arrays.previousMovedY[i] = arrays.movedY[i];
+		arrays.previousMovedZ[i] = arrays.movedZ[i];
+		arrays.previousRotationX[i] = arrays.rotationX[i];
+		arrays.previousRotationY[i] = arrays.rotationY[i];
+		arrays.previousRotationZ[i] = arrays.rotationZ[i];
+
+		float velocity = arrays.velocity[i];
+		arrays.movedX[i] += arrays.forwardX[i] * velocity;
+		arrays.movedY[i] += arrays.forwardY[i] * velocity;
+		arrays.movedZ[i] += arrays.forwardZ[i] * velocity;
+
+		float angularVelocity = arrays.angularVelocity[i];
+		arrays.rotationX[i] += arrays.forwardRotationX[i] * angularVelocity;
+		arrays.rotationY[i] += arrays.forwardRotationY[i] * angularVelocity;
+		arrays.rotationZ[i] += arrays.forwardRotationZ[i] * angularVelocity;
+
+		if (arrays.movedY[i] >= bounceMax || arrays.movedY[i] <= bounceMin) {
+			arrays.forwardX[i] = -arrays.forwardX[i];
+			arrays.forwardY[i] = -arrays.forwardY[i];
+			arrays.forwardZ[i] = -arrays.forwardZ[i];
+		}
+	}
+}
+
+
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+
+//Guarda el valor en previous y hace value += direction * speed con los helpers glm_vec4 de GLM
+//(fma real si se compila con AVX2)
+inline void IntegrateFour(float* value, float* previous, const float* direction, glm_vec4 speed, size_t i) {
+
+	glm_vec4 const current = _mm_loadu_ps(value + i);
+	_mm_storeu_ps(previous + i, current);
+	_mm_storeu_ps(value + i, glm_vec4_fma(_mm_loadu_ps(direction + i), speed, current));
+}
+
+
+//Invierte el signo de las lanes marcadas
+inline void FlipFour(float* value, glm_vec4 flip, size_t i) {
+
+	_mm_storeu_ps(value + i, _mm_xor_ps(_mm_loadu_ps(value + i), flip));
+}
+
+
+//Paso de simulacion de 4 objetos por iteracion con SSE
+size_t SimulateRangeSSE(SimulationArrays& arrays, size_t begin, size_t end, float bounceMin, float bounceMax) {
+
+	glm_vec4 const minimum = _mm_set1_ps(bounceMin);
+	glm_vec4 const maximum = _mm_set1_ps(bounceMax);
+	glm_vec4 const signBit = _mm_set1_ps(-0.f);
+
+	size_t i = begin;
+	for (; i + 4 <= end; i += 4) {
+
+		glm_vec4 const velocity = _mm_loadu_ps(arrays.velocity + i);
+		IntegrateFour(arrays.movedX, arrays.previousMovedX, arrays.forwardX, velocity, i);
+		IntegrateFour(arrays.movedY, arrays.previousMovedY, arrays.forwardY, velocity, i);
+		IntegrateFour(arrays.movedZ, arrays.previousMovedZ, arrays.forwardZ, velocity, i);
+
+		glm_vec4 const angularVelocity = _mm_loadu_ps(arrays.angularVelocity + i);
+		IntegrateFour(arrays.rotationX, arrays.previousRotationX, arrays.forwardRotationX, angularVelocity, i);
+		IntegrateFour(arrays.rotationY, arrays.previousRotationY, arrays.forwardRotationY, angularVelocity, i);
+		IntegrateFour(arrays.rotationZ, arrays.previousRotationZ, arrays.forwardRotationZ, angularVelocity, i);
+
+		//Rebote sin saltos: mascara de las lanes fuera de limites y xor con el bit de signo
+		glm_vec4 const movedY = _mm_loadu_ps(arrays.movedY + i);
+		glm_vec4 const outside = _mm_or_ps(_mm_cmpge_ps(movedY, maximum), _mm_cmple_ps(movedY, minimum));
+		if (_mm_movemask_ps(outside) != 0) {
+			glm_vec4 const flip = _mm_and_ps(outside, signBit);
+			FlipFour(arrays.forwardX, flip, i);
+			FlipFour(arrays.forwardY, flip, i);
+			FlipFour(arrays.forwardZ, flip, i);
+		}
+	}
+
+	return i;
+}
+
+#endif
+
+
+#if GLM_ARCH & GLM_ARCH_AVX_BIT
+
+inline void IntegrateEight(float* value, float* previous, const float* direction, __m256 speed, size_t i) {
+
+	__m256 const current = _mm256_loadu_ps(value + i);
+	_mm256_storeu_ps(previous + i, current);
+#if GLM_ARCH & GLM_ARCH_AVX2_BIT
+	_mm256_storeu_ps(value + i, _mm256_fmadd_ps(_mm256_loadu_ps(direction + i), speed, current));
+#else
+	_mm256_storeu_ps(value + i, _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(direction + i), speed), current));
+#endif
+}
+
+
+inline void FlipEight(float* value, __m256 flip, size_t i) {
+
+	_mm256_storeu_ps(value + i, _mm256_xor_ps(_mm256_loadu_ps(value + i), flip));
+}
+
+
+//Misma logica que la version SSE con 8 objetos por iteracion
+size_t SimulateRangeAVX(SimulationArrays& arrays, size_t begin, size_t end, float bounceMin, float bounceMax) {
+
+	__m256 const minimum = _mm256_set1_ps(bounceMin);
+	__m256 const maximum = _mm256_set1_ps(bounceMax);
+	__m256 const signBit = _mm256_set1_ps(-0.f);
+
+	size_t i = begin;
+	for (; i + 8 <= end; i += 8) {
+
+		__m256 const velocity = _mm256_loadu_ps(arrays.velocity + i);
+		IntegrateEight(arrays.movedX, arrays.previousMovedX, arrays.forwardX, velocity, i);
+		IntegrateEight(arrays.movedY, arrays.previousMovedY, arrays.forwardY, velocity, i);
+		IntegrateEight(arrays.movedZ, arrays.previousMovedZ, arrays.forwardZ, velocity, i);
+
+		__m256 const angularVelocity = _mm256_loadu_ps(arrays.angularVelocity + i);
+		IntegrateEight(arrays.rotationX, arrays.previousRotationX, arrays.forwardRotationX, angularVelocity, i);
+		IntegrateEight(arrays.rotationY, arrays.previousRotationY, arrays.forwardRotationY, angularVelocity, i);
+		IntegrateEight(arrays.rotationZ, arrays.previousRotationZ, arrays.forwardRotationZ, angularVelocity, i);
+
+		__m256 const movedY = _mm256_loadu_ps(arrays.movedY + i);
+		__m256 const outside = _mm256_or_ps(_mm256_cmp_ps(movedY, maximum, _CMP_GE_OQ), _mm256_cmp_ps(movedY, minimum, _CMP_LE_OQ));
+		if (_mm256_movemask_ps(outside) != 0) {
+			__m256 const flip = _mm256_and_ps(outside, signBit);
+			FlipEight(arrays.forwardX, flip, i);
+			FlipEight(arrays.forwardY, flip, i);
+			FlipEight(arrays.forwardZ, flip, i);
+		}
+	}
+
+	return i;
+}
+
+#endif
+
+
+void SimulateGameObjectRange(GameObjectArray& objects, size_t begin, size_t end) {
+
+	SimulationArrays arrays = GetSimulationArrays(objects);
+
+	//Cada version vectorial procesa los bloques completos que puede y devuelve donde se ha quedado
+	size_t i = begin;
+#if GLM_ARCH & GLM_ARCH_AVX_BIT
+	i = SimulateRangeAVX(arrays, i, end, objects.bounceMin, objects.bounceMax);
+#endif
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+	i = SimulateRangeSSE(arrays, i, end, objects.bounceMin, objects.bounceMax);
+#endif
+	SimulateRangeScalar(arrays, i, end, objects.bounceMin, objects.bounceMax);
+}
+
+
+void SimulateGameObjects(GameObjectArray& objects) {
+
+	SimulateGameObjectRange(objects, 0, objects.count);
+}
+
+
+void SimulateGameObjectsScalar(GameObjectArray& objects) {
+
+	SimulationArrays arrays = GetSimulationArrays(objects);
+	SimulateRangeScalar(arrays, 0, objects.count, objects.bounceMin, objects.bounceMax);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <glm.hpp>
+#include <vector>
+#include <cstddef>
+
+//Descripcion de un objeto al crearlo o al leerlo del contenedor
+struct GameObject {
+
+	glm::vec3 position = glm::vec3(0.f);
+	glm::vec3 rotation = glm::vec3(0.f);
+	glm::vec3 scale = glm::vec3(1.f);
+
+	glm::vec3 forward = glm::vec3(0.f);
+	glm::vec3 forwardRotation = glm::vec3(0.f);
+	float velocity = 0.0005f;
+	float angularVelocity = -.05f;
+};
+
+//Componente que avanza con forward * velocity y que rebota al salir de los limites en Y
+enum MovedComponent
+{
+	MOVE_POSITION,
+	MOVE_SCALE
+};
+
+//Objetos con el mismo comportamiento guardados como estructura de arrays: un array de floats por
+//componente, para que el paso de simulacion procese 4 u 8 objetos por instruccion
+struct GameObjectArray
+{
+	MovedComponent movedComponent = MOVE_POSITION;
+	float bounceMin = 0.f;
+	float bounceMax = 0.f;
+
+	size_t count = 0;
+
+	std::vector<float> positionX, positionY, positionZ;
+	std::vector<float> rotationX, rotationY, rotationZ;
+	std::vector<float> scaleX, scaleY, scaleZ;
+	std::vector<float> forwardX, forwardY, forwardZ;
+	std::vector<float> forwardRotationX, forwardRotationY, forwardRotationZ;
+	std::vector<float> velocity;
+	std::vector<float> angularVelocity;
+
+	//Estado del paso anterior del componente que se mueve y de la rotacion, para interpolar al dibujar
+	std::vector<float> previousMovedX, previousMovedY, previousMovedZ;
+	std::vector<float> previousRotationX, previousRotationY, previousRotationZ;
+};
+
+//El componente movido rebota cuando su Y es >= bounceMax o <= bounceMin
+GameObjectArray CreateGameObjectArray(MovedComponent movedComponent, float bounceMin, float bounceMax, size_t capacity = 0);
+
+size_t AddGameObject(GameObjectArray& objects, const GameObject& object);
+
+GameObject GetGameObject(const GameObjectArray& objects, size_t index);
+
+//Estado a dibujar entre el paso anterior (alpha = 0) y el actual (alpha = 1)
+GameObject InterpolateGameObject(const GameObjectArray& objects, size_t index, float alpha);
+
+//Multiplica la velocidad lineal y angular de un objeto
+void ScaleGameObjectVelocity(GameObjectArray& objects, size_t index, float factor);
+
+//Un paso fijo de simulacion: integra y rebota todos los objetos con SSE/AVX si estan disponibles
+void SimulateGameObjects(GameObjectArray& objects);
+
+//Paso de simulacion solo de los objetos [begin, end), para repartir el trabajo entre hilos
+void SimulateGameObjectRange(GameObjectArray& objects, size_t begin, size_t end);
+
+//Misma simulacion objeto a objeto, como referencia para el benchmark
+void SimulateGameObjectsScalar(GameObjectArray& objects);
@@ -0,0 +1,103 @@
+#include "GpuCulling.h"
+#include <glm.hpp>
+#include <algorithm>
+#include <cstddef>
+
+
+GpuCulling CreateGpuCulling(GLuint maxObjects) {
+
+	GpuCulling culling;
+	culling.maxObjects = maxObjects;
+
+	//Sin flags de mapeo: la CPU no lee ni escribe las matrices visibles
+	glGenBuffers(1, &culling.visibleBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, culling.visibleBuffer);
+	glBufferStorage(GL_SHADER_STORAGE_BUFFER, std::max<GLuint>(maxObjects, 1) * sizeof(glm::mat4), nullptr, 0);
+
+	//El comando se reinicia cada frame con glBufferSubData antes del dispatch
+	glGenBuffers(1, &culling.commandBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, culling.commandBuffer);
+	glBufferStorage(GL_SHADER_STORAGE_BUFFER, sizeof(DrawElementsIndirectCommand), nullptr, GL_DYNAMIC_STORAGE_BIT);
+
+	const GLuint firstTransform = 0;
+	glGenBuffers(1, &culling.parameterBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, culling.parameterBuffer);
+	glBufferStorage(GL_SHADER_STORAGE_BUFFER, sizeof(firstTransform), &firstTransform, 0);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	return culling;
+}
+
+
+void DispatchGpuCulling(GpuCulling& culling, GLStateCache& cache, GLuint program, const Frustum& frustum, const MeshRange& range,
+	GLuint objectBuffer, GLintptr objectOffset, GLuint count) {
+
+	count = std::min(count, culling.maxObjects);
+
+	//Comando de la malla sin instancias; el compute shader las va sumando
+	DrawElementsIndirectCommand command;
+	command.count = range.indexCount;
+	command.instanceCount = 0;
+	command.firstIndex = range.firstIndex;
+	command.baseVertex = range.baseVertex;
+	command.baseInstance = 0;
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, culling.commandBuffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(command), &command);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	if (count == 0)
+		return;
+
+	CachedUseProgram(cache, program);
+	glUniform4fv(GPU_CULL_FRUSTUM_LOCATION, 6, &frustum.planes[0].x);
+	glUniform4f(GPU_CULL_SPHERE_LOCATION, range.bounds.center.x, range.bounds.center.y, range.bounds.center.z, range.bounds.radius);
+	glUniform1ui(GPU_CULL_COUNT_LOCATION, count);
+
+	CachedBindBufferRange(cache, GL_SHADER_STORAGE_BUFFER, GPU_CULL_OBJECTS_BINDING, { objectBuffer, objectOffset, static_cast<GLsizeiptr>(count * sizeof(glm::mat4)) });
+	CachedBindBufferRange(cache, GL_SHADER_STORAGE_BUFFER, GPU_CULL_VISIBLE_BINDING, { culling.visibleBuffer, 0, static_cast<GLsizeiptr>(std::max<GLuint>(culling.maxObjects, 1) * sizeof(glm::mat4)) });
+	CachedBindBufferRange(cache, GL_SHADER_STORAGE_BUFFER, GPU_CULL_COMMAND_BINDING, { culling.commandBuffer, 0, sizeof(DrawElementsIndirectCommand) });
+
+	glDispatchCompute((count + GPU_CULL_GROUP_SIZE - 1) / GPU_CULL_GROUP_SIZE, 1, 1);
+
+	//El draw lee el comando como buffer indirecto y las matrices desde el vertex shader
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+
+RenderCommand GpuCulledCommand(const GpuCulling& culling, const MeshArena& arena) {
+
+	RenderCommand command;
+	command.vertexArray = arena.vao;
+	command.mode = arena.mode;
+	command.indexType = arena.indexType;
+	command.indirectBuffer = culling.commandBuffer;
+	command.indirectOffset = 0;
+	command.drawCount = 1;
+	command.transforms = { culling.visibleBuffer, 0, static_cast<GLsizeiptr>(std::max<GLuint>(culling.maxObjects, 1) * sizeof(glm::mat4)) };
+	command.parameters = { culling.parameterBuffer, 0, sizeof(GLuint) };
+	return command;
+}
+
+
+GLuint ReadGpuVisibleCount(const GpuCulling& culling) {
+
+	//Las escrituras del compute shader tienen que ser visibles para glGetBufferSubData
+	glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+	GLuint instanceCount = 0;
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, culling.commandBuffer);
+	glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, offsetof(DrawElementsIndirectCommand, instanceCount), sizeof(instanceCount), &instanceCount);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	return instanceCount;
+}
+
+
+void DestroyGpuCulling(GpuCulling& culling) {
+
+	glDeleteBuffers(1, &culling.visibleBuffer);
+	glDeleteBuffers(1, &culling.commandBuffer);
+	glDeleteBuffers(1, &culling.parameterBuffer);
+	culling = GpuCulling();
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Culling.h"
+#include "IndirectDraw.h"
+#include "RenderQueue.h"
+#include "StateCache.h"
+#include <GL/glew.h>
+
+//Objetos que prueba cada grupo de trabajo (local_size_x de CullingComputeShader.glsl)
+#define GPU_CULL_GROUP_SIZE 64
+
+//Puntos de binding de los SSBO del compute shader: candidatos, visibles compactados y comando indirecto
+#define GPU_CULL_OBJECTS_BINDING 2
+#define GPU_CULL_VISIBLE_BINDING 3
+#define GPU_CULL_COMMAND_BINDING 4
+
+//Localizaciones explicitas de los uniforms del compute shader, asi no hay que consultarlas al recargarlo
+#define GPU_CULL_FRUSTUM_LOCATION 0
+#define GPU_CULL_SPHERE_LOCATION 6
+#define GPU_CULL_COUNT_LOCATION 7
+
+//Distancia a los planos dentro de la cual la GPU y la CPU pueden decidir distinto por redondeo
+#define GPU_CULL_COMPARE_EPSILON 1e-4f
+
+//Culling en la GPU de los objetos de una malla. Un compute shader prueba la esfera de cada matriz contra el
+//frustum, copia las que pasan al principio de visibleBuffer y las cuenta con un atomicAdd sobre el instanceCount
+//del comando indirecto. El draw lee ese comando directamente, asi que la CPU no llega a saber cuantos objetos
+//se dibujan. Los dos buffers solo los usa la GPU y se reutilizan cada frame
+struct GpuCulling
+{
+	GLuint visibleBuffer = 0;
+	GLuint commandBuffer = 0;
+
+	//Un solo draw que empieza en la primera matriz de visibleBuffer (DrawParameters de los vertex shaders)
+	GLuint parameterBuffer = 0;
+
+	GLuint maxObjects = 0;
+};
+
+GpuCulling CreateGpuCulling(GLuint maxObjects);
+
+//Prueba las count matrices que hay a partir de objectOffset en objectBuffer con la esfera de la malla range.
+//Deja listo el comando de la malla con tantas instancias como objetos visibles
+void DispatchGpuCulling(GpuCulling& culling, GLStateCache& cache, GLuint program, const Frustum& frustum, const MeshRange& range,
+	GLuint objectBuffer, GLintptr objectOffset, GLuint count);
+
+//Comando que dibuja los objetos que han pasado el ultimo DispatchGpuCulling con lo que ha escrito la GPU
+//(falta el programa y el material)
+RenderCommand GpuCulledCommand(const GpuCulling& culling, const MeshArena& arena);
+
+//Lee cuantos objetos pasaron el ultimo culling. Espera a la GPU: solo para comprobaciones y estadisticas
+GLuint ReadGpuVisibleCount(const GpuCulling& culling);
+
+void DestroyGpuCulling(GpuCulling& culling);
@@ -0,0 +1,146 @@
+#include "IndirectDraw.h"
+#include <cstring>
+#include <iostream>
+
+
+bool SameMeshFormat(const MeshFileHeader& a, const MeshFileHeader& b) {
+
+	if (a.mode != b.mode || a.indexType != b.indexType || a.vertexStride != b.vertexStride || a.attributeCount != b.attributeCount)
+		return false;
+
+	return std::memcmp(a.attributes, b.attributes, a.attributeCount * sizeof(MeshFileAttribute)) == 0;
+}
+
+
+bool CreateMeshArena(MeshArena& arena, const std::vector<const MeshFile*>& files) {
+
+	arena = MeshArena();
+	if (files.empty())
+		return false;
+
+	//Todas las mallas se leen con los atributos y la primitiva de la primera
+	const MeshFileHeader& format = *files[0]->header;
+	std::uint64_t vertexSize = 0;
+	std::uint64_t indexSize = 0;
+	for (const MeshFile* file : files) {
+		if (!SameMeshFormat(format, *file->header)) {
+			std::cerr << "Las mallas de la arena no comparten formato de vertice, indices y primitiva" << std::endl;
+			return false;
+		}
+		vertexSize += file->header->vertexSize;
+		indexSize += file->header->indexSize;
+	}
+
+	arena.indexType = format.indexType;
+	arena.mode = format.mode;
+
+	glGenVertexArrays(1, &arena.vao);
+	glBindVertexArray(arena.vao);
+
+	//Se reserva todo de una vez y cada malla se copia desde su archivo mapeado, sin buffer intermedio
+	glGenBuffers(1, &arena.vertexBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, arena.vertexBuffer);
+	glBufferStorage(GL_ARRAY_BUFFER, vertexSize, nullptr, GL_DYNAMIC_STORAGE_BIT);
+
+	glGenBuffers(1, &arena.indexBuffer);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, arena.indexBuffer);
+	glBufferStorage(GL_ELEMENT_ARRAY_BUFFER, indexSize, nullptr, GL_DYNAMIC_STORAGE_BIT);
+
+	GLuint vertexCount = 0;
+	GLuint indexCount = 0;
+	for (const MeshFile* file : files) {
+		const MeshFileHeader& header = *file->header;
+
+		MeshRange range;
+		range.firstIndex = indexCount;
+		range.baseVertex = static_cast<GLint>(vertexCount);
+		range.indexCount = header.indexCount;
+		range.bounds = ComputeMeshFileBounds(*file);
+		arena.meshes.push_back(range);
+
+		glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(vertexCount) * header.vertexStride, header.vertexSize, file->vertexData);
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, indexCount * IndexTypeSize(header.indexType), header.indexSize, file->indexData);
+
+		vertexCount += header.vertexCount;
+		indexCount += header.indexCount;
+	}
+
+	for (std::uint32_t i = 0; i < format.attributeCount; i++) {
+		const MeshFileAttribute& attribute = format.attributes[i];
+		glVertexAttribPointer(attribute.location, attribute.components, attribute.type, GL_FALSE, format.vertexStride, (GLvoid*)(size_t)attribute.offset);
+		glEnableVertexAttribArray(attribute.location);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+
+	return true;
+}
+
+
+void ClearDrawBatch(DrawBatch& batch) {
+
+	//Sin liberar memoria: el lote se vuelve a llenar cada frame
+	batch.commands.clear();
+	batch.firstTransforms.clear();
+}
+
+
+void AddDraw(DrawBatch& batch, const MeshArena& arena, size_t mesh, GLuint instanceCount, GLuint firstTransform) {
+
+	//Un draw sin instancias no dibuja nada, pero ocuparia su hueco en el buffer indirecto
+	if (instanceCount == 0)
+		return;
+
+	const MeshRange& range = arena.meshes[mesh];
+
+	DrawElementsIndirectCommand command;
+	command.count = range.indexCount;
+	command.instanceCount = instanceCount;
+	command.firstIndex = range.firstIndex;
+	command.baseVertex = range.baseVertex;
+	command.baseInstance = 0;
+
+	batch.commands.push_back(command);
+	batch.firstTransforms.push_back(firstTransform);
+}
+
+
+bool WriteDrawBatch(const DrawBatch& batch, const MeshArena& arena, StreamBuffer& indirectStream, StreamBuffer& parameterStream, RenderCommand& command) {
+
+	if (batch.commands.empty())
+		return false;
+
+	GLsizeiptr commandsSize = batch.commands.size() * sizeof(DrawElementsIndirectCommand);
+	GLsizeiptr parametersSize = batch.firstTransforms.size() * sizeof(GLuint);
+	StreamAllocation commands = AllocateStream(indirectStream, commandsSize);
+	StreamAllocation parameters = AllocateStream(parameterStream, parametersSize);
+	if (commands.data == nullptr || parameters.data == nullptr)
+		return false;
+
+	std::memcpy(commands.data, batch.commands.data(), commandsSize);
+	std::memcpy(parameters.data, batch.firstTransforms.data(), parametersSize);
+
+	command.vertexArray = arena.vao;
+	command.mode = arena.mode;
+	command.indexType = arena.indexType;
+	command.indirectBuffer = indirectStream.buffer;
+	command.indirectOffset = commands.offset;
+	command.drawCount = static_cast<GLsizei>(batch.commands.size());
+
+	//gl_DrawIDARB empieza en 0 en cada llamada, asi que cada lote enlaza solo su trozo de parametros
+	command.parameters.buffer = parameterStream.buffer;
+	command.parameters.offset = parameters.offset;
+	command.parameters.size = parametersSize;
+
+	return true;
+}
+
+
+void DestroyMeshArena(MeshArena& arena) {
+
+	glDeleteVertexArrays(1, &arena.vao);
+	glDeleteBuffers(1, &arena.vertexBuffer);
+	glDeleteBuffers(1, &arena.indexBuffer);
+	arena = MeshArena();
+}
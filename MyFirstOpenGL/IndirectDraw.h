@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Culling.h"
+#include "MeshFile.h"
+#include "RenderQueue.h"
+#include "StreamBuffer.h"
+#include <GL/glew.h>
+#include <cstddef>
+#include <vector>
+
+//Parametros de un draw de glMultiDrawElementsIndirect, con el layout que fija GL
+struct DrawElementsIndirectCommand
+{
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+};
+
+//Trozo de la arena que ocupa una malla. firstIndex va en indices y baseVertex en vertices, como en el comando
+struct MeshRange
+{
+	GLuint firstIndex = 0;
+	GLint baseVertex = 0;
+	GLuint indexCount = 0;
+	Bounds bounds;
+};
+
+//Todas las mallas en un solo VBO y un solo EBO detras de un unico VAO, para dibujar cualquier mezcla de ellas con
+//un solo draw indirecto. Comparten formato de vertice, tipo de indice y primitiva. Los indices de cada malla siguen
+//siendo locales (baseVertex los desplaza despues de comparar con el de reinicio), asi que caben en 16 bits igual que antes
+struct MeshArena
+{
+	GLuint vao = 0;
+	GLuint vertexBuffer = 0;
+	GLuint indexBuffer = 0;
+	GLenum indexType = GL_UNSIGNED_SHORT;
+	GLenum mode = GL_TRIANGLES;
+	std::vector<MeshRange> meshes;
+};
+
+//Draws de un mismo programa que se envian juntos. firstTransforms[i] es la posicion de la primera matriz del draw i
+//en el buffer de transformaciones; el vertex shader la lee con gl_DrawIDARB y le suma gl_InstanceID
+struct DrawBatch
+{
+	std::vector<DrawElementsIndirectCommand> commands;
+	std::vector<GLuint> firstTransforms;
+};
+
+//Copia los vertices y los indices de los archivos, en orden, a buffers inmutables. meshes[i] es el trozo de files[i].
+//Devuelve false si los archivos no comparten formato
+bool CreateMeshArena(MeshArena& arena, const std::vector<const MeshFile*>& files);
+
+void ClearDrawBatch(DrawBatch& batch);
+
+//Anade instanceCount objetos de la malla mesh de la arena con sus matrices a partir de firstTransform
+void AddDraw(DrawBatch& batch, const MeshArena& arena, size_t mesh, GLuint instanceCount, GLuint firstTransform);
+
+//Escribe los comandos en indirectStream y los firstTransforms en parameterStream y rellena command para lanzar
+//todo el lote con un glMultiDrawElementsIndirect (falta el programa, el material y las matrices). El coste en CPU
+//depende de cuantas mallas distintas hay, no de cuantos objetos. Devuelve false si el lote esta vacio o no cabia
+bool WriteDrawBatch(const DrawBatch& batch, const MeshArena& arena, StreamBuffer& indirectStream, StreamBuffer& parameterStream, RenderCommand& command);
+
+void DestroyMeshArena(MeshArena& arena);
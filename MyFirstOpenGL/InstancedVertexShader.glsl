@@ -0,0 +1,29 @@
+#version 440 core
+#extension GL_ARB_shader_draw_parameters : require
+
+layout(location = 0) in vec3 posicion;
+
+//Matrices de modelo de todos los objetos del frame
+layout(std430, binding = 0) readonly buffer ObjectTransforms
+{
+    mat4 modelMatrices[];
+};
+
+//Primera matriz de cada draw del glMultiDrawElementsIndirect, indexada con gl_DrawIDARB
+layout(std430, binding = 1) readonly buffer DrawParameters
+{
+    uint firstTransforms[];
+};
+
+//Proyeccion * vista de la camara
+layout(std140, binding = 1) uniform CameraTransform
+{
+    mat4 viewProjection;
+};
+
+
+void main()
+{
+    mat4 modelMatrix = modelMatrices[firstTransforms[gl_DrawIDARB] + gl_InstanceID];
+    gl_Position = viewProjection * modelMatrix * vec4(posicion, 1.0);
+}
\ No newline at end of file
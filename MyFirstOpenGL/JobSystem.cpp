@@ -0,0 +1,162 @@
+#include "JobSystem.h"
+
+
+//Cola del hilo actual dentro de su JobSystem (0 para el hilo principal)
+thread_local size_t currentQueue = 0;
+
+
+void PushJob(JobSystem& jobSystem, size_t queueIndex, const Job& job) {
+
+	JobQueue& queue = jobSystem.queues[queueIndex];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back(job);
+	}
+	jobSystem.queuedJobs.fetch_add(1);
+
+	//Solo pasamos por el mutex si hay alguien dormido
+	if (jobSystem.sleepingWorkers.load() > 0) {
+		std::lock_guard<std::mutex> lock(jobSystem.sleepMutex);
+		jobSystem.wakeUp.notify_one();
+	}
+}
+
+
+//Saca el ultimo trabajo de la cola propia o, si esta vacia, roba el primero de otra
+bool FindJob(JobSystem& jobSystem, size_t queueIndex, Job& job) {
+
+	if (jobSystem.queuedJobs.load() == 0)
+		return false;
+
+	{
+		JobQueue& queue = jobSystem.queues[queueIndex];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.jobs.empty()) {
+			job = queue.jobs.back();
+			queue.jobs.pop_back();
+			jobSystem.queuedJobs.fetch_sub(1);
+			return true;
+		}
+	}
+
+	//Empezamos por la cola siguiente para que cada hilo robe a uno distinto
+	for (size_t offset = 1; offset < jobSystem.queueCount; offset++) {
+		JobQueue& victim = jobSystem.queues[(queueIndex + offset) % jobSystem.queueCount];
+		std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+		if (!lock.owns_lock() || victim.jobs.empty())
+			continue;
+
+		job = victim.jobs.front();
+		victim.jobs.pop_front();
+		jobSystem.queuedJobs.fetch_sub(1);
+		jobSystem.jobsStolen.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	return false;
+}
+
+
+//Parte el rango por la mitad dejando la mitad derecha en la cola propia, para que otros hilos la roben,
+//hasta llegar al tamano minimo, y ejecuta el trozo que queda
+void RunJob(JobSystem& jobSystem, size_t queueIndex, Job job) {
+
+	while (job.end - job.begin > job.group->grain) {
+		size_t middle = job.begin + (job.end - job.begin) / 2;
+		PushJob(jobSystem, queueIndex, { job.group, middle, job.end });
+		job.end = middle;
+	}
+
+	(*job.group->function)(job.begin, job.end);
+
+	jobSystem.jobsExecuted.fetch_add(1, std::memory_order_relaxed);
+	job.group->remaining.fetch_sub(job.end - job.begin, std::memory_order_acq_rel);
+}
+
+
+void WorkerLoop(JobSystem& jobSystem, size_t queueIndex) {
+
+	currentQueue = queueIndex;
+
+	while (jobSystem.running.load()) {
+
+		Job job;
+		if (FindJob(jobSystem, queueIndex, job)) {
+			RunJob(jobSystem, queueIndex, job);
+			continue;
+		}
+
+		//Sin trabajo dormimos hasta que alguien meta uno en cualquier cola
+		std::unique_lock<std::mutex> lock(jobSystem.sleepMutex);
+		jobSystem.sleepingWorkers.fetch_add(1);
+		jobSystem.wakeUp.wait(lock, [&jobSystem]() {
+			return !jobSystem.running.load() || jobSystem.queuedJobs.load() > 0;
+		});
+		jobSystem.sleepingWorkers.fetch_sub(1);
+	}
+}
+
+
+void CreateJobSystem(JobSystem& jobSystem, size_t workerCount) {
+
+	jobSystem.queueCount = workerCount + 1;
+	jobSystem.queues.reset(new JobQueue[jobSystem.queueCount]);
+	jobSystem.running = true;
+
+	currentQueue = 0;
+	for (size_t i = 0; i < workerCount; i++)
+		jobSystem.workers.emplace_back(WorkerLoop, std::ref(jobSystem), i + 1);
+}
+
+
+void ParallelFor(JobSystem& jobSystem, size_t count, size_t grain, const JobFunction& function) {
+
+	if (count == 0)
+		return;
+
+	//Sin workers o con poco trabajo no compensa repartir
+	if (jobSystem.workers.empty() || count <= grain) {
+		function(0, count);
+		return;
+	}
+
+	JobGroup group;
+	group.function = &function;
+	group.grain = grain > 0 ? grain : 1;
+	group.remaining = count;
+
+	RunJob(jobSystem, currentQueue, { &group, 0, count });
+
+	//Mientras otros hilos acaban sus trozos ayudamos con lo que quede en las colas
+	while (group.remaining.load(std::memory_order_acquire) > 0) {
+		Job job;
+		if (FindJob(jobSystem, currentQueue, job))
+			RunJob(jobSystem, currentQueue, job);
+		else
+			std::this_thread::yield();
+	}
+}
+
+
+void DestroyJobSystem(JobSystem& jobSystem) {
+
+	{
+		std::lock_guard<std::mutex> lock(jobSystem.sleepMutex);
+		jobSystem.running = false;
+	}
+	jobSystem.wakeUp.notify_all();
+
+	for (std::thread& worker : jobSystem.workers)
+		worker.join();
+
+	jobSystem.workers.clear();
+	jobSystem.queues.reset();
+	jobSystem.queueCount = 0;
+}
+
+
+size_t DefaultWorkerCount() {
+
+	unsigned int cores = std::thread::hardware_concurrency();
+	return cores > 1 ? cores - 1 : 0;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Funcion que procesa el rango [begin, end) de un ParallelFor
+typedef std::function<void(size_t begin, size_t end)> JobFunction;
+
+//Trabajos de un mismo ParallelFor: se da por terminado cuando no quedan elementos pendientes
+struct JobGroup
+{
+	const JobFunction* function = nullptr;
+	size_t grain = 1;
+	std::atomic<size_t> remaining{ 0 };
+};
+
+struct Job
+{
+	JobGroup* group = nullptr;
+	size_t begin = 0;
+	size_t end = 0;
+};
+
+//Cola de cada hilo: el dueno mete y saca por detras y los demas roban por delante
+struct JobQueue
+{
+	std::mutex mutex;
+	std::deque<Job> jobs;
+};
+
+//Planificador con robo de trabajo. La cola 0 es la del hilo que llama a ParallelFor (el de render),
+//que tambien ejecuta trabajos mientras espera; el resto son de los workers
+struct JobSystem
+{
+	std::vector<std::thread> workers;
+	std::unique_ptr<JobQueue[]> queues;
+	size_t queueCount = 0;
+
+	std::atomic<bool> running{ false };
+	std::atomic<size_t> queuedJobs{ 0 };
+	std::atomic<size_t> sleepingWorkers{ 0 };
+	std::mutex sleepMutex;
+	std::condition_variable wakeUp;
+
+	//Trabajos ejecutados y robados desde que se creo, para ver el reparto
+	std::atomic<size_t> jobsExecuted{ 0 };
+	std::atomic<size_t> jobsStolen{ 0 };
+};
+
+//workerCount hilos ademas del que llama; 0 ejecuta todo en el hilo que llama
+void CreateJobSystem(JobSystem& jobSystem, size_t workerCount);
+
+//Divide [0, count) en mitades hasta rangos de grain elementos y los reparte entre los hilos.
+//Vuelve cuando se han procesado todos. Solo se puede llamar desde el hilo que creo el JobSystem
+void ParallelFor(JobSystem& jobSystem, size_t count, size_t grain, const JobFunction& function);
+
+void DestroyJobSystem(JobSystem& jobSystem);
+
+//Hilos de trabajo por defecto: todos los nucleos menos el del hilo principal
+size_t DefaultWorkerCount();
@@ -0,0 +1,244 @@
+#include "Mesh.h"
+#include <algorithm>
+#include <cmath>
+
+
+GLuint AddMeshVertex(MeshBuilder& builder, const glm::vec3& position) {
+
+	//Sumar 0 convierte -0 en +0 para que ambos tengan el mismo hash
+	glm::vec3 key = position + glm::vec3(0.f);
+
+	auto found = builder.vertexIndices.find(key);
+	if (found != builder.vertexIndices.end())
+		return found->second;
+
+	GLuint index = static_cast<GLuint>(builder.mesh.positions.size());
+	builder.mesh.positions.push_back(key);
+	builder.vertexIndices.emplace(key, index);
+	return index;
+}
+
+
+void AddTriangleStrip(MeshBuilder& builder, const GLfloat* positions, size_t vertexCount) {
+
+	MeshData& mesh = builder.mesh;
+	mesh.mode = GL_TRIANGLE_STRIP;
+
+	if (!mesh.indices.empty())
+		mesh.indices.push_back(MESH_RESTART_INDEX);
+
+	for (size_t i = 0; i < vertexCount; i++)
+		mesh.indices.push_back(AddMeshVertex(builder, glm::vec3(positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2])));
+}
+
+
+void AddTriangles(MeshBuilder& builder, const GLfloat* positions, size_t vertexCount) {
+
+	MeshData& mesh = builder.mesh;
+	mesh.mode = GL_TRIANGLES;
+
+	for (size_t i = 0; i + 3 <= vertexCount; i += 3)
+		for (size_t corner = i; corner < i + 3; corner++)
+			mesh.indices.push_back(AddMeshVertex(builder, glm::vec3(positions[corner * 3], positions[corner * 3 + 1], positions[corner * 3 + 2])));
+}
+
+
+std::vector<GLuint> StripToTriangles(const std::vector<GLuint>& strip) {
+
+	std::vector<GLuint> triangles;
+	size_t stripStart = 0;
+
+	for (size_t i = 0; i < strip.size(); i++) {
+
+		if (strip[i] == MESH_RESTART_INDEX) {
+			stripStart = i + 1;
+			continue;
+		}
+		if (i - stripStart < 2)
+			continue;
+
+		GLuint a = strip[i - 2], b = strip[i - 1], c = strip[i];
+		if (a == b || b == c || a == c)
+			continue;
+
+		//Los triangulos impares de la tira tienen el giro invertido
+		if ((i - stripStart) % 2 == 1)
+			std::swap(a, b);
+
+		triangles.push_back(a);
+		triangles.push_back(b);
+		triangles.push_back(c);
+	}
+
+	return triangles;
+}
+
+
+//Puntuacion de un vertice en el algoritmo de Forsyth: premia estar al principio de la cache y tener
+//pocos triangulos pendientes, para terminar zonas en vez de dejar islas
+float ForsythVertexScore(int cachePosition, int remainingTriangles) {
+
+	if (remainingTriangles == 0)
+		return -1.f;
+
+	float score = 0.f;
+	if (cachePosition >= 0) {
+		//Los tres vertices del ultimo triangulo puntuan algo menos para no repetir siempre la misma arista
+		if (cachePosition < 3)
+			score = 0.75f;
+		else
+			score = std::pow(1.f - static_cast<float>(cachePosition - 3) / (FORSYTH_CACHE_SIZE - 3), 1.5f);
+	}
+
+	return score + 2.f / std::sqrt(static_cast<float>(remainingTriangles));
+}
+
+
+void OptimizeVertexCache(MeshData& mesh) {
+
+	if (mesh.mode != GL_TRIANGLES || mesh.indices.size() < 6)
+		return;
+
+	size_t triangleCount = mesh.indices.size() / 3;
+	size_t vertexCount = mesh.positions.size();
+
+	//Triangulos de cada vertice en un solo array: los de v estan en [triangleOffsets[v], triangleOffsets[v] + remaining[v])
+	std::vector<int> remaining(vertexCount, 0);
+	for (size_t i = 0; i < triangleCount * 3; i++)
+		remaining[mesh.indices[i]]++;
+
+	std::vector<size_t> triangleOffsets(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; v++)
+		triangleOffsets[v + 1] = triangleOffsets[v] + remaining[v];
+
+	std::vector<GLuint> vertexTriangles(triangleCount * 3);
+	std::vector<size_t> fill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+	for (size_t t = 0; t < triangleCount; t++)
+		for (size_t corner = 0; corner < 3; corner++)
+			vertexTriangles[fill[mesh.indices[t * 3 + corner]]++] = static_cast<GLuint>(t);
+
+	std::vector<int> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScore(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++)
+		vertexScore[v] = ForsythVertexScore(-1, remaining[v]);
+
+	std::vector<float> triangleScore(triangleCount);
+	std::vector<bool> emitted(triangleCount, false);
+	for (size_t t = 0; t < triangleCount; t++)
+		triangleScore[t] = vertexScore[mesh.indices[t * 3]] + vertexScore[mesh.indices[t * 3 + 1]] + vertexScore[mesh.indices[t * 3 + 2]];
+
+	std::vector<GLuint> optimized;
+	optimized.reserve(triangleCount * 3);
+	std::vector<GLuint> cache, nextCache;
+	cache.reserve(FORSYTH_CACHE_SIZE + 3);
+	nextCache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+	size_t bestTriangle = 0;
+	bool haveBest = true;
+	size_t scanPosition = 0;
+
+	//Empezamos por el triangulo de mayor puntuacion
+	for (size_t t = 1; t < triangleCount; t++)
+		if (triangleScore[t] > triangleScore[bestTriangle])
+			bestTriangle = t;
+
+	while (optimized.size() < triangleCount * 3) {
+
+		//Si ningun vertice de la cache tiene triangulos pendientes seguimos por el siguiente sin emitir
+		if (!haveBest) {
+			while (emitted[scanPosition])
+				scanPosition++;
+			bestTriangle = scanPosition;
+		}
+
+		emitted[bestTriangle] = true;
+		const GLuint* corners = &mesh.indices[bestTriangle * 3];
+
+		nextCache.assign(corners, corners + 3);
+		for (size_t corner = 0; corner < 3; corner++) {
+			GLuint v = corners[corner];
+			optimized.push_back(v);
+
+			//Quitamos el triangulo de los pendientes del vertice
+			GLuint* begin = &vertexTriangles[triangleOffsets[v]];
+			GLuint* end = begin + remaining[v];
+			std::iter_swap(std::find(begin, end, static_cast<GLuint>(bestTriangle)), end - 1);
+			remaining[v]--;
+		}
+
+		for (GLuint v : cache)
+			if (v != corners[0] && v != corners[1] && v != corners[2])
+				nextCache.push_back(v);
+
+		//Los que quedan fuera de la cache pierden la puntuacion de posicion
+		for (size_t i = 0; i < nextCache.size(); i++) {
+			GLuint v = nextCache[i];
+			cachePosition[v] = i < FORSYTH_CACHE_SIZE ? static_cast<int>(i) : -1;
+			vertexScore[v] = ForsythVertexScore(cachePosition[v], remaining[v]);
+		}
+
+		//Recalculamos solo los triangulos que tocan la cache o los vertices que acaban de salir
+		haveBest = false;
+		float bestScore = -1.f;
+		for (GLuint v : nextCache) {
+			for (int i = 0; i < remaining[v]; i++) {
+				GLuint t = vertexTriangles[triangleOffsets[v] + i];
+				const GLuint* triangle = &mesh.indices[t * 3];
+				triangleScore[t] = vertexScore[triangle[0]] + vertexScore[triangle[1]] + vertexScore[triangle[2]];
+				if (triangleScore[t] > bestScore) {
+					bestScore = triangleScore[t];
+					bestTriangle = t;
+					haveBest = true;
+				}
+			}
+		}
+
+		cache.assign(nextCache.begin(), nextCache.begin() + std::min<size_t>(nextCache.size(), FORSYTH_CACHE_SIZE));
+	}
+
+	mesh.indices.swap(optimized);
+}
+
+
+void OptimizeVertexFetch(MeshData& mesh) {
+
+	std::vector<GLuint> remap(mesh.positions.size(), MESH_RESTART_INDEX);
+	std::vector<glm::vec3> positions;
+	positions.reserve(mesh.positions.size());
+
+	for (GLuint& index : mesh.indices) {
+		if (index == MESH_RESTART_INDEX)
+			continue;
+
+		if (remap[index] == MESH_RESTART_INDEX) {
+			remap[index] = static_cast<GLuint>(positions.size());
+			positions.push_back(mesh.positions[index]);
+		}
+		index = remap[index];
+	}
+
+	mesh.positions.swap(positions);
+}
+
+
+float ComputeACMR(const MeshData& mesh, size_t cacheSize) {
+
+	std::vector<GLuint> triangles = mesh.mode == GL_TRIANGLE_STRIP ? StripToTriangles(mesh.indices) : mesh.indices;
+	if (triangles.size() < 3)
+		return 0.f;
+
+	//FIFO con marcas de tiempo: un vertice sigue en la cache si han entrado menos de cacheSize desde el
+	size_t time = cacheSize + 1;
+	std::vector<size_t> timestamps(mesh.positions.size(), 0);
+	size_t misses = 0;
+
+	for (GLuint index : triangles) {
+		if (time - timestamps[index] > cacheSize) {
+			timestamps[index] = time++;
+			misses++;
+		}
+	}
+
+	return static_cast<float>(misses) / static_cast<float>(triangles.size() / 3);
+}
+
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+//Indice que corta una tira de triangulos. Con indices GLuint es el que usa GL_PRIMITIVE_RESTART_FIXED_INDEX
+#define MESH_RESTART_INDEX 0xFFFFFFFFu
+
+//Vertices que caben en la cache de vertices transformados que simula ComputeACMR (FIFO, como la mayoria de GPUs)
+#define VERTEX_CACHE_FIFO_SIZE 16
+
+//Tamano de la cache LRU que usa el algoritmo de Forsyth para puntuar vertices en OptimizeVertexCache
+#define FORSYTH_CACHE_SIZE 32
+
+//Malla indexada en CPU: posiciones sin repetir e indices. Con GL_TRIANGLE_STRIP las tiras se separan con
+//MESH_RESTART_INDEX; con GL_TRIANGLES cada tres indices forman un triangulo
+struct MeshData
+{
+	std::vector<glm::vec3> positions;
+	std::vector<GLuint> indices;
+	GLenum mode = GL_TRIANGLES;
+};
+
+//Hash por bits de una posicion. -0 y +0 se igualan antes de llegar aqui
+struct PositionHash
+{
+	size_t operator()(const glm::vec3& position) const {
+		std::uint32_t bits[3];
+		std::memcpy(bits, &position, sizeof(bits));
+		return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+	}
+};
+
+//Construye un MeshData quitando los vertices repetidos a medida que se anaden
+struct MeshBuilder
+{
+	MeshData mesh;
+	std::unordered_map<glm::vec3, GLuint, PositionHash> vertexIndices;
+};
+
+//Devuelve el indice de la posicion, anadiendola si no estaba
+GLuint AddMeshVertex(MeshBuilder& builder, const glm::vec3& position);
+
+//Anade una tira de vertexCount posiciones (x, y, z). Si ya habia otra se separa con MESH_RESTART_INDEX
+void AddTriangleStrip(MeshBuilder& builder, const GLfloat* positions, size_t vertexCount);
+
+//Anade triangulos sueltos, tres posiciones (x, y, z) por triangulo
+void AddTriangles(MeshBuilder& builder, const GLfloat* positions, size_t vertexCount);
+
+//Pasa tiras con MESH_RESTART_INDEX a una lista de triangulos con el mismo sentido de giro, sin los degenerados
+std::vector<GLuint> StripToTriangles(const std::vector<GLuint>& strip);
+
+//Reordena los triangulos de una malla GL_TRIANGLES para aprovechar la cache de vertices (algoritmo de Forsyth)
+void OptimizeVertexCache(MeshData& mesh);
+
+//Reordena las posiciones por orden de primer uso en los indices y quita las que no se usan
+void OptimizeVertexFetch(MeshData& mesh);
+
+//Vertices transformados por triangulo simulando una cache FIFO de cacheSize vertices. 0.5 es el minimo
+//teorico en mallas grandes y 3 el peor caso
+float ComputeACMR(const MeshData& mesh, size_t cacheSize = VERTEX_CACHE_FIFO_SIZE);
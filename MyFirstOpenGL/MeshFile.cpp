@@ -0,0 +1,211 @@
+#include "MeshFile.h"
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+
+std::uint64_t AlignMeshOffset(std::uint64_t offset) {
+
+	return (offset + MESH_FILE_ALIGNMENT - 1) / MESH_FILE_ALIGNMENT * MESH_FILE_ALIGNMENT;
+}
+
+
+std::uint64_t IndexTypeSize(std::uint32_t indexType) {
+
+	switch (indexType) {
+	case GL_UNSIGNED_SHORT:
+		return sizeof(GLushort);
+	case GL_UNSIGNED_INT:
+		return sizeof(GLuint);
+	default:
+		return 0;
+	}
+}
+
+
+std::uint64_t AttributeTypeSize(std::uint32_t type) {
+
+	switch (type) {
+	case GL_BYTE:
+	case GL_UNSIGNED_BYTE:
+		return 1;
+	case GL_SHORT:
+	case GL_UNSIGNED_SHORT:
+	case GL_HALF_FLOAT:
+		return 2;
+	case GL_INT:
+	case GL_UNSIGNED_INT:
+	case GL_FLOAT:
+		return 4;
+	default:
+		return 0;
+	}
+}
+
+
+bool IsMeshFileMode(std::uint32_t mode) {
+
+	switch (mode) {
+	case GL_POINTS:
+	case GL_LINES:
+	case GL_LINE_LOOP:
+	case GL_LINE_STRIP:
+	case GL_TRIANGLES:
+	case GL_TRIANGLE_STRIP:
+	case GL_TRIANGLE_FAN:
+		return true;
+	default:
+		return false;
+	}
+}
+
+
+//Cada atributo tiene que caber entero dentro de un vertice
+bool AreMeshFileAttributesValid(const MeshFileHeader& header) {
+
+	for (std::uint32_t i = 0; i < header.attributeCount; i++) {
+		const MeshFileAttribute& attribute = header.attributes[i];
+		std::uint64_t componentSize = AttributeTypeSize(attribute.type);
+		if (attribute.location >= MESH_FILE_MAX_LOCATIONS || attribute.components < 1 || attribute.components > 4 || componentSize == 0
+			|| static_cast<std::uint64_t>(attribute.offset) + attribute.components * componentSize > header.vertexStride)
+			return false;
+	}
+
+	return true;
+}
+
+
+//Un bloque esta dentro del archivo sin que offset + size pueda desbordar
+bool IsMeshBlockInside(std::uint64_t offset, std::uint64_t size, std::uint64_t fileSize) {
+
+	return offset <= fileSize && size <= fileSize - offset;
+}
+
+
+//Con GL_PRIMITIVE_RESTART_FIXED_INDEX el valor maximo del tipo reinicia la tira en vez de leer un vertice
+bool AreMeshIndicesValid(const MeshFileHeader& header, const GLubyte* indexData) {
+
+	bool shortIndices = header.indexType == GL_UNSIGNED_SHORT;
+	std::uint32_t restartIndex = shortIndices ? 0xFFFFu : 0xFFFFFFFFu;
+	for (std::uint32_t i = 0; i < header.indexCount; i++) {
+		std::uint32_t index = shortIndices ? reinterpret_cast<const GLushort*>(indexData)[i] : reinterpret_cast<const GLuint*>(indexData)[i];
+		if (index >= header.vertexCount && index != restartIndex)
+			return false;
+	}
+
+	return true;
+}
+
+
+bool WriteMeshFile(const std::string& filePath, const MeshData& mesh) {
+
+	MeshFileHeader header = {};
+	header.magic = MESH_FILE_MAGIC;
+	header.version = MESH_FILE_VERSION;
+	header.mode = mesh.mode;
+	header.vertexCount = static_cast<std::uint32_t>(mesh.positions.size());
+	header.indexCount = static_cast<std::uint32_t>(mesh.indices.size());
+	header.vertexStride = sizeof(glm::vec3);
+	header.attributeCount = 1;
+	header.attributes[0] = { 0, 3, GL_FLOAT, 0 };
+
+	//Con menos de 65535 vertices los indices caben en 16 bits y 0xFFFF sigue libre para reiniciar tiras
+	bool shortIndices = mesh.positions.size() < 0xFFFF;
+	header.indexType = shortIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+	header.vertexOffset = AlignMeshOffset(sizeof(MeshFileHeader));
+	header.vertexSize = static_cast<std::uint64_t>(header.vertexCount) * header.vertexStride;
+	header.indexOffset = AlignMeshOffset(header.vertexOffset + header.vertexSize);
+	header.indexSize = header.indexCount * IndexTypeSize(header.indexType);
+
+	std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) {
+		std::cerr << "No se ha podido crear el archivo de malla: " << filePath << std::endl;
+		return false;
+	}
+
+	const char padding[MESH_FILE_ALIGNMENT] = {};
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(padding, header.vertexOffset - sizeof(header));
+	file.write(reinterpret_cast<const char*>(mesh.positions.data()), header.vertexSize);
+	file.write(padding, header.indexOffset - (header.vertexOffset + header.vertexSize));
+
+	if (shortIndices) {
+		std::vector<GLushort> indices(mesh.indices.begin(), mesh.indices.end());
+		file.write(reinterpret_cast<const char*>(indices.data()), header.indexSize);
+	}
+	else {
+		file.write(reinterpret_cast<const char*>(mesh.indices.data()), header.indexSize);
+	}
+
+	return static_cast<bool>(file);
+}
+
+
+bool MapMeshFile(const std::string& filePath, MeshFile& file) {
+
+	file = MeshFile();
+	if (!MapFile(filePath, file.view)) {
+		std::cerr << "No se ha podido abrir el archivo de malla: " << filePath << std::endl;
+		return false;
+	}
+
+	const MeshFileHeader* header = reinterpret_cast<const MeshFileHeader*>(file.view.data);
+	const char* error = nullptr;
+
+	//Comprobamos todo lo que luego se pasa a GL para no leer fuera del archivo ni de los vertices
+	if (file.view.size < sizeof(MeshFileHeader) || header->magic != MESH_FILE_MAGIC)
+		error = "no es un archivo .mesh";
+	else if (header->version != MESH_FILE_VERSION)
+		error = "version no soportada";
+	else if (!IsMeshFileMode(header->mode) || IndexTypeSize(header->indexType) == 0
+		|| header->vertexStride == 0 || header->vertexStride > MESH_FILE_MAX_STRIDE
+		|| header->attributeCount == 0 || header->attributeCount > MESH_FILE_MAX_ATTRIBUTES)
+		error = "cabecera invalida";
+	else if (!AreMeshFileAttributesValid(*header))
+		error = "atributos invalidos";
+	else if (header->vertexOffset % MESH_FILE_ALIGNMENT != 0 || header->indexOffset % MESH_FILE_ALIGNMENT != 0)
+		error = "bloques sin alinear";
+	else if (header->vertexSize != static_cast<std::uint64_t>(header->vertexCount) * header->vertexStride
+		|| header->indexSize != header->indexCount * IndexTypeSize(header->indexType)
+		|| header->vertexSize == 0 || header->indexSize == 0
+		|| !IsMeshBlockInside(header->vertexOffset, header->vertexSize, file.view.size)
+		|| !IsMeshBlockInside(header->indexOffset, header->indexSize, file.view.size))
+		error = "bloques fuera del archivo";
+	else if (!AreMeshIndicesValid(*header, reinterpret_cast<const GLubyte*>(file.view.data) + header->indexOffset))
+		error = "indices fuera de los vertices";
+
+	if (error != nullptr) {
+		std::cerr << "Archivo de malla " << filePath << ": " << error << std::endl;
+		UnmapFile(file.view);
+		return false;
+	}
+
+	file.header = header;
+	file.vertexData = reinterpret_cast<const GLubyte*>(file.view.data) + header->vertexOffset;
+	file.indexData = reinterpret_cast<const GLubyte*>(file.view.data) + header->indexOffset;
+	return true;
+}
+
+
+Bounds ComputeMeshFileBounds(const MeshFile& file) {
+
+	const MeshFileHeader& header = *file.header;
+
+	//Las posiciones son el atributo 0
+	for (std::uint32_t i = 0; i < header.attributeCount; i++) {
+		const MeshFileAttribute& attribute = header.attributes[i];
+		if (attribute.location == 0 && attribute.components == 3 && attribute.type == GL_FLOAT
+			&& attribute.offset + sizeof(glm::vec3) <= header.vertexStride)
+			return ComputeBounds(file.vertexData + attribute.offset, header.vertexCount, header.vertexStride);
+	}
+
+	return Bounds();
+}
+
+
+void UnmapMeshFile(MeshFile& file) {
+
+	UnmapFile(file.view);
+	file = MeshFile();
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Culling.h"
+#include "File.h"
+#include "Mesh.h"
+#include <GL/glew.h>
+#include <cstdint>
+#include <string>
+
+//Formato binario de mallas (.mesh), little-endian:
+//  MeshFileHeader | vertices (vertexCount * vertexStride bytes) | indices (indexCount * tamano de indexType)
+//Cada bloque empieza alineado a MESH_FILE_ALIGNMENT para poder pasar punteros al archivo mapeado directamente a GL
+#define MESH_FILE_MAGIC 0x4853454Du //"MESH"
+#define MESH_FILE_VERSION 1
+#define MESH_FILE_ALIGNMENT 64
+#define MESH_FILE_MAX_ATTRIBUTES 8
+
+//Minimos que garantiza OpenGL 4.4 para GL_MAX_VERTEX_ATTRIBS y GL_MAX_VERTEX_ATTRIB_STRIDE
+#define MESH_FILE_MAX_LOCATIONS 16
+#define MESH_FILE_MAX_STRIDE 2048
+
+//Un atributo de vertice tal y como se pasa a glVertexAttribPointer
+struct MeshFileAttribute
+{
+	std::uint32_t location;
+	std::uint32_t components;
+	std::uint32_t type;
+	std::uint32_t offset;
+};
+
+struct MeshFileHeader
+{
+	std::uint32_t magic;
+	std::uint32_t version;
+	std::uint32_t mode;
+	std::uint32_t indexType;
+	std::uint32_t vertexCount;
+	std::uint32_t indexCount;
+	std::uint32_t vertexStride;
+	std::uint32_t attributeCount;
+	MeshFileAttribute attributes[MESH_FILE_MAX_ATTRIBUTES];
+	std::uint64_t vertexOffset;
+	std::uint64_t vertexSize;
+	std::uint64_t indexOffset;
+	std::uint64_t indexSize;
+};
+
+static_assert(sizeof(MeshFileHeader) % MESH_FILE_ALIGNMENT == 0, "La cabecera debe mantener alineados los bloques");
+
+//Archivo .mesh mapeado en memoria. Los punteros apuntan a las paginas del archivo, sin copias
+struct MeshFile
+{
+	FileView view;
+	const MeshFileHeader* header = nullptr;
+	const GLubyte* vertexData = nullptr;
+	const GLubyte* indexData = nullptr;
+};
+
+//Bytes de un indice de tipo GL_UNSIGNED_SHORT o GL_UNSIGNED_INT, 0 con cualquier otro
+std::uint64_t IndexTypeSize(std::uint32_t indexType);
+
+//Guarda las posiciones en el atributo 0 y los indices en 16 bits si caben (el reinicio de tira pasa a ser 0xFFFF)
+bool WriteMeshFile(const std::string& filePath, const MeshData& mesh);
+
+//Bytes de un componente de atributo de tipo entero, GL_HALF_FLOAT o GL_FLOAT, 0 con cualquier otro
+std::uint64_t AttributeTypeSize(std::uint32_t type);
+
+//Mapea el archivo y comprueba la cabecera, los atributos, que los bloques esten dentro del archivo y que ningun
+//indice (salvo el de reinicio) se salga de los vertices. Devuelve false si algo no es valido
+bool MapMeshFile(const std::string& filePath, MeshFile& file);
+
+//Caja y esfera de las posiciones (atributo 0, vec3 float) del archivo mapeado. Vacios si no las tiene
+Bounds ComputeMeshFileBounds(const MeshFile& file);
+
+void UnmapMeshFile(MeshFile& file);
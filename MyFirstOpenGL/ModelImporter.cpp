@@ -0,0 +1,758 @@
+#include "ModelImporter.h"
+#include "File.h"
+#include "MeshFile.h"
+#include <gtc/matrix_transform.hpp>
+#include <gtc/quaternion.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+//Cabecera y tipos de bloque de un .glb
+#define GLB_MAGIC 0x46546C67u //"glTF"
+#define GLB_VERSION 2
+#define GLB_CHUNK_JSON 0x4E4F534Au
+#define GLB_CHUNK_BIN 0x004E4942u
+
+//Anidamiento maximo de objetos y arrays en el JSON de un glTF
+#define JSON_MAX_DEPTH 128
+
+//componentType de los accesores de glTF (los mismos valores que GL_UNSIGNED_BYTE, GL_FLOAT...)
+#define GLTF_UNSIGNED_BYTE 5121
+#define GLTF_UNSIGNED_SHORT 5123
+#define GLTF_UNSIGNED_INT 5125
+#define GLTF_FLOAT 5126
+
+#define GLTF_MODE_TRIANGLES 4
+
+
+bool ImportError(const std::string& filePath, const char* message) {
+
+	std::cerr << "No se ha podido importar " << filePath << ": " << message << std::endl;
+	return false;
+}
+
+
+//Quita las posiciones repetidas de una malla ya indexada. El hash es secuencial; la reescritura de indices se reparte
+void WeldPositions(MeshData& mesh, JobSystem& jobSystem) {
+
+	MeshBuilder builder;
+	builder.vertexIndices.reserve(mesh.positions.size());
+
+	std::vector<GLuint> remap(mesh.positions.size());
+	for (size_t i = 0; i < mesh.positions.size(); i++)
+		remap[i] = AddMeshVertex(builder, mesh.positions[i]);
+
+	mesh.positions.swap(builder.mesh.positions);
+
+	ParallelFor(jobSystem, mesh.indices.size(), IMPORT_JOB_GRAIN, [&mesh, &remap](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++)
+			mesh.indices[i] = remap[mesh.indices[i]];
+	});
+}
+
+
+//Trozo de un OBJ y lo que se ha leido de el
+struct ObjChunk
+{
+	const char* begin = nullptr;
+	const char* end = nullptr;
+	std::vector<glm::vec3> positions;
+
+	//Esquinas de los triangulos. Los indices positivos del OBJ se guardan ya en base 0; los negativos cuentan
+	//hacia atras desde la linea en la que estan y se guardan respecto al primer vertice del trozo
+	std::vector<std::int64_t> corners;
+	std::vector<size_t> relativeCorners;
+	bool valid = true;
+};
+
+
+const char* SkipSpaces(const char* p, const char* end) {
+
+	while (p < end && (*p == ' ' || *p == '\t'))
+		p++;
+	return p;
+}
+
+
+bool ParseObjFloat(const char*& p, const char* end, float& value) {
+
+	p = SkipSpaces(p, end);
+
+	//from_chars no acepta el signo +
+	if (p < end && *p == '+')
+		p++;
+
+	std::from_chars_result result = std::from_chars(p, end, value);
+	p = result.ptr;
+	return result.ec == std::errc();
+}
+
+
+void AddObjCorner(ObjChunk& chunk, std::int64_t index) {
+
+	if (index > 0) {
+		chunk.corners.push_back(index - 1);
+		return;
+	}
+
+	chunk.relativeCorners.push_back(chunk.corners.size());
+	chunk.corners.push_back(static_cast<std::int64_t>(chunk.positions.size()) + index);
+}
+
+
+//Lee las lineas v y f del trozo; el resto (vn, vt, o, g, usemtl, comentarios...) se ignora
+void ParseObjChunk(ObjChunk& chunk) {
+
+	std::vector<std::int64_t> polygon;
+	const char* p = chunk.begin;
+
+	while (p < chunk.end && chunk.valid) {
+
+		const char* line = SkipSpaces(p, chunk.end);
+		const char* next = static_cast<const char*>(std::memchr(line, '\n', chunk.end - line));
+		next = next != nullptr ? next + 1 : chunk.end;
+		p = next;
+
+		if (next - line < 2 || (line[1] != ' ' && line[1] != '\t'))
+			continue;
+
+		if (line[0] == 'v') {
+			const char* cursor = line + 2;
+			glm::vec3 position;
+			chunk.valid = ParseObjFloat(cursor, next, position.x) && ParseObjFloat(cursor, next, position.y) && ParseObjFloat(cursor, next, position.z);
+			chunk.positions.push_back(position);
+		}
+		else if (line[0] == 'f') {
+			polygon.clear();
+			const char* cursor = SkipSpaces(line + 2, next);
+			while (cursor < next && *cursor != '\n' && *cursor != '\r' && *cursor != '#') {
+				std::int64_t index = 0;
+				std::from_chars_result result = std::from_chars(cursor, next, index);
+				if (result.ec != std::errc() || index == 0) {
+					chunk.valid = false;
+					break;
+				}
+				polygon.push_back(index);
+
+				//Saltamos /vt/vn hasta la siguiente esquina
+				cursor = result.ptr;
+				while (cursor < next && *cursor != ' ' && *cursor != '\t' && *cursor != '\n' && *cursor != '\r')
+					cursor++;
+				cursor = SkipSpaces(cursor, next);
+			}
+
+			if (polygon.size() < 3)
+				chunk.valid = false;
+
+			//Triangulamos en abanico desde la primera esquina
+			for (size_t i = 2; chunk.valid && i < polygon.size(); i++) {
+				AddObjCorner(chunk, polygon[0]);
+				AddObjCorner(chunk, polygon[i - 1]);
+				AddObjCorner(chunk, polygon[i]);
+			}
+		}
+	}
+}
+
+
+bool ImportOBJ(const std::string& filePath, MeshData& mesh, JobSystem& jobSystem) {
+
+	FileView file;
+	if (!MapFile(filePath, file))
+		return ImportError(filePath, "no se puede abrir");
+
+	//Cortamos el archivo en trozos que terminan en salto de linea para que ninguna linea quede partida
+	std::vector<ObjChunk> chunks;
+	const char* fileEnd = file.data + file.size;
+	for (const char* cursor = file.data; cursor < fileEnd;) {
+		const char* chunkEnd = cursor + std::min<size_t>(OBJ_CHUNK_SIZE, fileEnd - cursor);
+		const char* newline = static_cast<const char*>(std::memchr(chunkEnd - 1, '\n', fileEnd - (chunkEnd - 1)));
+		chunkEnd = newline != nullptr ? newline + 1 : fileEnd;
+
+		chunks.emplace_back();
+		chunks.back().begin = cursor;
+		chunks.back().end = chunkEnd;
+		cursor = chunkEnd;
+	}
+
+	ParallelFor(jobSystem, chunks.size(), 1, [&chunks](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++)
+			ParseObjChunk(chunks[i]);
+	});
+
+	//Con lo que ha leido cada trozo sabemos donde empiezan sus vertices y esquinas en el resultado
+	std::vector<size_t> positionBase(chunks.size()), cornerBase(chunks.size());
+	size_t positionCount = 0, cornerCount = 0;
+	bool valid = true;
+	for (size_t i = 0; i < chunks.size(); i++) {
+		valid = valid && chunks[i].valid;
+		positionBase[i] = positionCount;
+		cornerBase[i] = cornerCount;
+		positionCount += chunks[i].positions.size();
+		cornerCount += chunks[i].corners.size();
+	}
+
+	if (!valid || positionCount >= MESH_RESTART_INDEX) {
+		UnmapFile(file);
+		return ImportError(filePath, valid ? "demasiados vertices" : "linea v o f invalida");
+	}
+
+	mesh = MeshData();
+	mesh.mode = GL_TRIANGLES;
+	mesh.positions.resize(positionCount);
+	mesh.indices.resize(cornerCount);
+
+	std::atomic<bool> indicesValid{ true };
+	ParallelFor(jobSystem, chunks.size(), 1, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			ObjChunk& chunk = chunks[i];
+			std::copy(chunk.positions.begin(), chunk.positions.end(), mesh.positions.begin() + positionBase[i]);
+
+			for (size_t corner : chunk.relativeCorners)
+				chunk.corners[corner] += static_cast<std::int64_t>(positionBase[i]);
+
+			for (size_t corner = 0; corner < chunk.corners.size(); corner++) {
+				std::int64_t index = chunk.corners[corner];
+				if (index < 0 || index >= static_cast<std::int64_t>(positionCount)) {
+					indicesValid = false;
+					break;
+				}
+				mesh.indices[cornerBase[i] + corner] = static_cast<GLuint>(index);
+			}
+		}
+	});
+
+	UnmapFile(file);
+
+	if (!indicesValid)
+		return ImportError(filePath, "una cara usa un vertice que no existe");
+	if (mesh.indices.empty())
+		return ImportError(filePath, "no tiene caras");
+
+	WeldPositions(mesh, jobSystem);
+	return true;
+}
+
+
+enum JsonType { JSON_NULL, JSON_BOOL, JSON_NUMBER, JSON_STRING, JSON_ARRAY, JSON_OBJECT };
+
+//Valor JSON. Los arrays usan values; los objetos keys y values en paralelo
+struct JsonValue
+{
+	JsonType type = JSON_NULL;
+	bool boolean = false;
+	double number = 0.0;
+	std::string string;
+	std::vector<std::string> keys;
+	std::vector<JsonValue> values;
+};
+
+
+const char* SkipJsonSpaces(const char* p, const char* end) {
+
+	while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+		p++;
+	return p;
+}
+
+
+bool ParseJsonString(const char*& p, const char* end, std::string& string) {
+
+	if (p >= end || *p != '"')
+		return false;
+	p++;
+
+	while (p < end && *p != '"') {
+		if (*p != '\\') {
+			string.push_back(*p++);
+			continue;
+		}
+
+		if (++p >= end)
+			return false;
+
+		char escaped = *p++;
+		switch (escaped) {
+		case '"': case '\\': case '/': string.push_back(escaped); break;
+		case 'b': string.push_back('\b'); break;
+		case 'f': string.push_back('\f'); break;
+		case 'n': string.push_back('\n'); break;
+		case 'r': string.push_back('\r'); break;
+		case 't': string.push_back('\t'); break;
+		case 'u': {
+			//Codigo de 16 bits a UTF-8. Los nombres de glTF no afectan a la geometria, asi que no se juntan los pares suplentes
+			unsigned int code = 0;
+			if (end - p < 4 || std::from_chars(p, p + 4, code, 16).ptr != p + 4)
+				return false;
+			p += 4;
+			if (code < 0x80) {
+				string.push_back(static_cast<char>(code));
+			}
+			else if (code < 0x800) {
+				string.push_back(static_cast<char>(0xC0 | (code >> 6)));
+				string.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+			}
+			else {
+				string.push_back(static_cast<char>(0xE0 | (code >> 12)));
+				string.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+				string.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+			}
+			break;
+		}
+		default:
+			return false;
+		}
+	}
+
+	if (p >= end)
+		return false;
+	p++;
+	return true;
+}
+
+
+bool ParseJsonValue(const char*& p, const char* end, JsonValue& value, int depth) {
+
+	p = SkipJsonSpaces(p, end);
+	if (p >= end || depth > JSON_MAX_DEPTH)
+		return false;
+
+	if (*p == '{' || *p == '[') {
+		bool isObject = *p == '{';
+		char close = isObject ? '}' : ']';
+		value.type = isObject ? JSON_OBJECT : JSON_ARRAY;
+
+		p = SkipJsonSpaces(p + 1, end);
+		if (p < end && *p == close) {
+			p++;
+			return true;
+		}
+
+		while (true) {
+			if (isObject) {
+				value.keys.emplace_back();
+				p = SkipJsonSpaces(p, end);
+				if (!ParseJsonString(p, end, value.keys.back()))
+					return false;
+				p = SkipJsonSpaces(p, end);
+				if (p >= end || *p != ':')
+					return false;
+				p++;
+			}
+
+			value.values.emplace_back();
+			if (!ParseJsonValue(p, end, value.values.back(), depth + 1))
+				return false;
+
+			p = SkipJsonSpaces(p, end);
+			if (p < end && *p == ',') {
+				p++;
+				continue;
+			}
+			if (p < end && *p == close) {
+				p++;
+				return true;
+			}
+			return false;
+		}
+	}
+
+	if (*p == '"') {
+		value.type = JSON_STRING;
+		return ParseJsonString(p, end, value.string);
+	}
+
+	const char* literals[] = { "true", "false", "null" };
+	for (const char* literal : literals) {
+		size_t length = std::strlen(literal);
+		if (static_cast<size_t>(end - p) >= length && std::memcmp(p, literal, length) == 0) {
+			value.type = literal[0] == 'n' ? JSON_NULL : JSON_BOOL;
+			value.boolean = literal[0] == 't';
+			p += length;
+			return true;
+		}
+	}
+
+	value.type = JSON_NUMBER;
+	std::from_chars_result result = std::from_chars(p, end, value.number);
+	p = result.ptr;
+	return result.ec == std::errc();
+}
+
+
+const JsonValue* JsonMember(const JsonValue& object, const char* name) {
+
+	for (size_t i = 0; i < object.keys.size(); i++)
+		if (object.keys[i] == name)
+			return &object.values[i];
+	return nullptr;
+}
+
+
+const JsonValue* JsonElement(const JsonValue* array, size_t index) {
+
+	if (array == nullptr || array->type != JSON_ARRAY || index >= array->values.size())
+		return nullptr;
+	return &array->values[index];
+}
+
+
+//Entero no negativo de un miembro; defaultValue si no esta y SIZE_MAX si no es valido, para que falle al comprobar rangos
+size_t JsonSize(const JsonValue& object, const char* name, size_t defaultValue) {
+
+	const JsonValue* member = JsonMember(object, name);
+	if (member == nullptr)
+		return defaultValue;
+	if (member->type != JSON_NUMBER || !(member->number >= 0.0) || member->number >= 9007199254740992.0)
+		return SIZE_MAX;
+	return static_cast<size_t>(member->number);
+}
+
+
+//Lo que hace falta del glTF mientras se recorren sus nodos
+struct GltfImport
+{
+	const JsonValue* accessors = nullptr;
+	const JsonValue* bufferViews = nullptr;
+	const JsonValue* meshes = nullptr;
+	const JsonValue* nodes = nullptr;
+	const GLubyte* binary = nullptr;
+	size_t binarySize = 0;
+
+	MeshData* mesh = nullptr;
+	JobSystem* jobSystem = nullptr;
+	size_t skippedPrimitives = 0;
+};
+
+//Elementos de un accesor dentro del bloque binario
+struct GltfAccessor
+{
+	const GLubyte* data = nullptr;
+	size_t count = 0;
+	size_t stride = 0;
+	size_t componentType = 0;
+	size_t components = 0;
+};
+
+
+bool ReadGltfAccessor(const GltfImport& gltf, size_t index, GltfAccessor& accessor) {
+
+	//Los accesores dispersos o sin bufferView no se usan para geometria en la practica
+	const JsonValue* json = JsonElement(gltf.accessors, index);
+	if (json == nullptr || JsonMember(*json, "sparse") != nullptr)
+		return false;
+	const JsonValue* view = JsonElement(gltf.bufferViews, JsonSize(*json, "bufferView", SIZE_MAX));
+	if (view == nullptr || JsonSize(*view, "buffer", 0) != 0)
+		return false;
+
+	const JsonValue* type = JsonMember(*json, "type");
+	if (type == nullptr || type->type != JSON_STRING)
+		return false;
+	accessor.components = type->string == "SCALAR" ? 1 : type->string == "VEC2" ? 2 : type->string == "VEC3" ? 3 : type->string == "VEC4" ? 4 : 0;
+
+	accessor.componentType = JsonSize(*json, "componentType", 0);
+	size_t componentSize = 0;
+	switch (accessor.componentType) {
+	case 5120: case GLTF_UNSIGNED_BYTE: componentSize = 1; break;
+	case 5122: case GLTF_UNSIGNED_SHORT: componentSize = 2; break;
+	case GLTF_UNSIGNED_INT: case GLTF_FLOAT: componentSize = 4; break;
+	}
+
+	size_t elementSize = componentSize * accessor.components;
+	size_t viewOffset = JsonSize(*view, "byteOffset", 0);
+	size_t viewLength = JsonSize(*view, "byteLength", SIZE_MAX);
+	size_t accessorOffset = JsonSize(*json, "byteOffset", 0);
+	accessor.count = JsonSize(*json, "count", SIZE_MAX);
+	accessor.stride = JsonSize(*view, "byteStride", 0);
+	if (accessor.stride == 0)
+		accessor.stride = elementSize;
+
+	//Comprobamos cada suma por separado para que valores enormes no den la vuelta
+	if (elementSize == 0 || accessor.count == SIZE_MAX || viewOffset > gltf.binarySize || viewLength > gltf.binarySize - viewOffset
+		|| accessorOffset > viewLength || accessor.stride > gltf.binarySize)
+		return false;
+	if (accessor.count > 0 && (accessor.count - 1 > (viewLength - accessorOffset) / accessor.stride
+		|| (accessor.count - 1) * accessor.stride + elementSize > viewLength - accessorOffset))
+		return false;
+
+	accessor.data = gltf.binary + viewOffset + accessorOffset;
+	return true;
+}
+
+
+bool AppendGltfPrimitive(GltfImport& gltf, const JsonValue& primitive, const glm::mat4& transform) {
+
+	const JsonValue* attributes = JsonMember(primitive, "attributes");
+	const JsonValue* position = attributes != nullptr ? JsonMember(*attributes, "POSITION") : nullptr;
+	if (JsonSize(primitive, "mode", GLTF_MODE_TRIANGLES) != GLTF_MODE_TRIANGLES || position == nullptr) {
+		gltf.skippedPrimitives++;
+		return true;
+	}
+
+	GltfAccessor positions;
+	if (!ReadGltfAccessor(gltf, JsonSize(*attributes, "POSITION", SIZE_MAX), positions) || positions.componentType != GLTF_FLOAT || positions.components != 3)
+		return false;
+
+	MeshData& mesh = *gltf.mesh;
+	size_t positionBase = mesh.positions.size();
+	mesh.positions.resize(positionBase + positions.count);
+
+	ParallelFor(*gltf.jobSystem, positions.count, IMPORT_JOB_GRAIN, [&mesh, &positions, &transform, positionBase](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			glm::vec3 local;
+			std::memcpy(&local, positions.data + i * positions.stride, sizeof(glm::vec3));
+			mesh.positions[positionBase + i] = glm::vec3(transform * glm::vec4(local, 1.f));
+		}
+	});
+
+	//Sin indices cada tres vertices forman un triangulo
+	size_t indexBase = mesh.indices.size();
+	const JsonValue* indicesMember = JsonMember(primitive, "indices");
+	if (indicesMember == nullptr) {
+		mesh.indices.resize(indexBase + positions.count / 3 * 3);
+		for (size_t i = indexBase; i < mesh.indices.size(); i++)
+			mesh.indices[i] = static_cast<GLuint>(positionBase + (i - indexBase));
+		return true;
+	}
+
+	GltfAccessor indices;
+	if (!ReadGltfAccessor(gltf, JsonSize(primitive, "indices", SIZE_MAX), indices) || indices.components != 1
+		|| (indices.componentType != GLTF_UNSIGNED_BYTE && indices.componentType != GLTF_UNSIGNED_SHORT && indices.componentType != GLTF_UNSIGNED_INT))
+		return false;
+
+	//Si sobra algun indice (count no multiplo de 3) lo descartamos
+	size_t indexCount = indices.count / 3 * 3;
+	mesh.indices.resize(indexBase + indexCount);
+
+	std::atomic<bool> valid{ true };
+	ParallelFor(*gltf.jobSystem, indexCount, IMPORT_JOB_GRAIN, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			const GLubyte* element = indices.data + i * indices.stride;
+			std::uint32_t index = 0;
+			if (indices.componentType == GLTF_UNSIGNED_BYTE) {
+				index = *element;
+			}
+			else if (indices.componentType == GLTF_UNSIGNED_SHORT) {
+				std::uint16_t index16;
+				std::memcpy(&index16, element, sizeof(index16));
+				index = index16;
+			}
+			else {
+				std::memcpy(&index, element, sizeof(index));
+			}
+
+			if (index >= positions.count) {
+				valid = false;
+				return;
+			}
+			mesh.indices[indexBase + i] = static_cast<GLuint>(positionBase + index);
+		}
+	});
+
+	return valid;
+}
+
+
+//Matriz local de un nodo: matrix si la tiene, si no T * R * S
+glm::mat4 GltfNodeMatrix(const JsonValue& node) {
+
+	const JsonValue* matrix = JsonMember(node, "matrix");
+	if (matrix != nullptr && matrix->type == JSON_ARRAY && matrix->values.size() == 16) {
+		glm::mat4 result;
+		for (int i = 0; i < 16; i++)
+			result[i / 4][i % 4] = static_cast<float>(matrix->values[i].number);
+		return result;
+	}
+
+	glm::vec3 translation(0.f), scale(1.f);
+	glm::quat rotation(1.f, 0.f, 0.f, 0.f);
+
+	const JsonValue* member = JsonMember(node, "translation");
+	if (member != nullptr && member->type == JSON_ARRAY && member->values.size() == 3)
+		translation = glm::vec3(member->values[0].number, member->values[1].number, member->values[2].number);
+
+	//glTF guarda la rotacion como x, y, z, w y glm::quat se construye como w, x, y, z
+	member = JsonMember(node, "rotation");
+	if (member != nullptr && member->type == JSON_ARRAY && member->values.size() == 4)
+		rotation = glm::quat(static_cast<float>(member->values[3].number), static_cast<float>(member->values[0].number),
+			static_cast<float>(member->values[1].number), static_cast<float>(member->values[2].number));
+
+	member = JsonMember(node, "scale");
+	if (member != nullptr && member->type == JSON_ARRAY && member->values.size() == 3)
+		scale = glm::vec3(member->values[0].number, member->values[1].number, member->values[2].number);
+
+	return glm::translate(glm::mat4(1.f), translation) * glm::mat4_cast(rotation) * glm::scale(glm::mat4(1.f), scale);
+}
+
+
+bool AppendGltfMesh(GltfImport& gltf, size_t meshIndex, const glm::mat4& transform) {
+
+	const JsonValue* mesh = JsonElement(gltf.meshes, meshIndex);
+	if (mesh == nullptr)
+		return false;
+
+	const JsonValue* primitives = JsonMember(*mesh, "primitives");
+	if (primitives == nullptr || primitives->type != JSON_ARRAY)
+		return false;
+
+	for (const JsonValue& primitive : primitives->values)
+		if (!AppendGltfPrimitive(gltf, primitive, transform))
+			return false;
+	return true;
+}
+
+
+bool AppendGltfNode(GltfImport& gltf, size_t nodeIndex, const glm::mat4& parent, int depth) {
+
+	const JsonValue* node = JsonElement(gltf.nodes, nodeIndex);
+	if (node == nullptr || depth > GLTF_MAX_NODE_DEPTH)
+		return false;
+
+	glm::mat4 world = parent * GltfNodeMatrix(*node);
+
+	if (JsonMember(*node, "mesh") != nullptr && !AppendGltfMesh(gltf, JsonSize(*node, "mesh", SIZE_MAX), world))
+		return false;
+
+	const JsonValue* children = JsonMember(*node, "children");
+	if (children != nullptr && children->type == JSON_ARRAY) {
+		for (const JsonValue& child : children->values)
+			if (child.type != JSON_NUMBER || child.number < 0.0 || !AppendGltfNode(gltf, static_cast<size_t>(child.number), world, depth + 1))
+				return false;
+	}
+
+	return true;
+}
+
+
+bool ImportGLB(const std::string& filePath, MeshData& mesh, JobSystem& jobSystem) {
+
+	FileView file;
+	if (!MapFile(filePath, file))
+		return ImportError(filePath, "no se puede abrir");
+
+	const GLubyte* data = reinterpret_cast<const GLubyte*>(file.data);
+	const char* error = nullptr;
+
+	//Cabecera de 12 bytes y bloque JSON obligatorio; el bloque binario es opcional
+	std::uint32_t header[3] = {};
+	std::uint32_t jsonChunk[2] = {};
+	if (file.size >= sizeof(header) + sizeof(jsonChunk)) {
+		std::memcpy(header, data, sizeof(header));
+		std::memcpy(jsonChunk, data + sizeof(header), sizeof(jsonChunk));
+	}
+
+	size_t jsonOffset = sizeof(header) + sizeof(jsonChunk);
+	if (header[0] != GLB_MAGIC || header[1] != GLB_VERSION)
+		error = "no es un glTF 2.0 binario";
+	else if (jsonChunk[1] != GLB_CHUNK_JSON || jsonChunk[0] > file.size - jsonOffset)
+		error = "bloque JSON invalido";
+
+	GltfImport gltf;
+	JsonValue root;
+	if (error == nullptr) {
+		size_t binaryOffset = jsonOffset + jsonChunk[0];
+		std::uint32_t binaryChunk[2] = {};
+		if (file.size >= binaryOffset + sizeof(binaryChunk)) {
+			std::memcpy(binaryChunk, data + binaryOffset, sizeof(binaryChunk));
+			if (binaryChunk[1] == GLB_CHUNK_BIN && binaryChunk[0] <= file.size - binaryOffset - sizeof(binaryChunk)) {
+				gltf.binary = data + binaryOffset + sizeof(binaryChunk);
+				gltf.binarySize = binaryChunk[0];
+			}
+		}
+
+		const char* json = file.data + jsonOffset;
+		if (!ParseJsonValue(json, file.data + jsonOffset + jsonChunk[0], root, 0) || root.type != JSON_OBJECT)
+			error = "JSON invalido";
+	}
+
+	if (error == nullptr) {
+		gltf.accessors = JsonMember(root, "accessors");
+		gltf.bufferViews = JsonMember(root, "bufferViews");
+		gltf.meshes = JsonMember(root, "meshes");
+		gltf.nodes = JsonMember(root, "nodes");
+		gltf.mesh = &mesh;
+		gltf.jobSystem = &jobSystem;
+
+		mesh = MeshData();
+		mesh.mode = GL_TRIANGLES;
+
+		//Recorremos los nodos de la escena por defecto; sin escenas se importan todas las mallas tal cual
+		bool valid = true;
+		const JsonValue* scene = JsonElement(JsonMember(root, "scenes"), JsonSize(root, "scene", 0));
+		if (scene != nullptr) {
+			const JsonValue* sceneNodes = JsonMember(*scene, "nodes");
+			for (size_t i = 0; valid && sceneNodes != nullptr && i < sceneNodes->values.size(); i++) {
+				const JsonValue& node = sceneNodes->values[i];
+				valid = node.type == JSON_NUMBER && node.number >= 0.0 && AppendGltfNode(gltf, static_cast<size_t>(node.number), glm::mat4(1.f), 0);
+			}
+		}
+		else if (gltf.meshes != nullptr) {
+			for (size_t i = 0; valid && i < gltf.meshes->values.size(); i++)
+				valid = AppendGltfMesh(gltf, i, glm::mat4(1.f));
+		}
+
+		if (!valid)
+			error = "nodos, mallas o accesores invalidos";
+		else if (mesh.positions.size() >= MESH_RESTART_INDEX)
+			error = "demasiados vertices";
+		else if (mesh.indices.empty())
+			error = "no tiene triangulos";
+	}
+
+	UnmapFile(file);
+	if (error != nullptr)
+		return ImportError(filePath, error);
+
+	if (gltf.skippedPrimitives > 0)
+		std::cout << filePath << ": " << gltf.skippedPrimitives << " primitivas sin triangulos o sin posiciones ignoradas" << std::endl;
+
+	WeldPositions(mesh, jobSystem);
+	return true;
+}
+
+
+bool ImportModel(const std::string& filePath, MeshData& mesh, JobSystem& jobSystem) {
+
+	std::string extension = std::filesystem::path(filePath).extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+	if (extension == ".obj")
+		return ImportOBJ(filePath, mesh, jobSystem);
+	if (extension == ".glb")
+		return ImportGLB(filePath, mesh, jobSystem);
+
+	return ImportError(filePath, "formato no soportado (solo .obj y .glb)");
+}
+
+
+bool ConvertModel(const std::string& inputPath, const std::string& outputPath, size_t workerCount) {
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	JobSystem jobSystem;
+	CreateJobSystem(jobSystem, workerCount);
+	MeshData mesh;
+	bool imported = ImportModel(inputPath, mesh, jobSystem);
+	DestroyJobSystem(jobSystem);
+
+	if (!imported)
+		return false;
+
+	float acmrBefore = ComputeACMR(mesh);
+	OptimizeVertexCache(mesh);
+	OptimizeVertexFetch(mesh);
+
+	if (!WriteMeshFile(outputPath, mesh))
+		return false;
+
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	std::cout << inputPath << " -> " << outputPath << ": " << mesh.positions.size() << " vertices, " << mesh.indices.size() / 3
+		<< " triangulos, ACMR " << acmrBefore << " -> " << ComputeACMR(mesh) << " (" << elapsed.count() << " ms)" << std::endl;
+	return true;
+}
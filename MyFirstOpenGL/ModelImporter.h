@@ -0,0 +1,30 @@
+#pragma once
+
+#include "JobSystem.h"
+#include "Mesh.h"
+#include <string>
+
+//Bytes de texto OBJ que procesa cada trabajo. Cada trozo se alarga hasta el siguiente salto de linea
+#define OBJ_CHUNK_SIZE (4 * 1024 * 1024)
+
+//Elementos minimos por trabajo al copiar posiciones e indices al resultado
+#define IMPORT_JOB_GRAIN 65536
+
+//Profundidad maxima de la jerarquia de nodos de un glTF (evita bucles en archivos corruptos)
+#define GLTF_MAX_NODE_DEPTH 64
+
+//Los importadores solo leen posiciones, que es el formato de vertice del motor; normales y coordenadas de
+//textura se ignoran. El resultado es una malla GL_TRIANGLES indexada y sin posiciones repetidas, lista para
+//WriteMeshFile. Devuelven false si el archivo no existe o no es valido
+
+//Wavefront OBJ: el archivo mapeado se parte en trozos que se parsean en paralelo. Los poligonos se triangulan en abanico
+bool ImportOBJ(const std::string& filePath, MeshData& mesh, JobSystem& jobSystem);
+
+//glTF 2.0 binario (.glb): todas las primitivas de triangulos de la escena con las transformaciones de sus nodos aplicadas
+bool ImportGLB(const std::string& filePath, MeshData& mesh, JobSystem& jobSystem);
+
+//Elige el importador por la extension (.obj o .glb)
+bool ImportModel(const std::string& filePath, MeshData& mesh, JobSystem& jobSystem);
+
+//Importa el modelo, optimiza cache de vertices y orden de lectura y lo guarda como .mesh (--convert)
+bool ConvertModel(const std::string& inputPath, const std::string& outputPath, size_t workerCount);
@@ -0,0 +1,60 @@
+#include "ModelMatrix.h"
+
+
+glm::mat3 AxisAngleRotation(glm::vec3 axis, float degrees) {
+
+	float lengthSquared = glm::dot(axis, axis);
+	if (lengthSquared == 0.f)
+		return glm::mat3(1.f);
+
+	//Formula de Rodrigues, con los mismos terminos que glm::rotate
+	glm::vec3 unit = axis * (1.f / glm::sqrt(lengthSquared));
+	float angle = glm::radians(degrees);
+	float c = glm::cos(angle);
+	float s = glm::sin(angle);
+	glm::vec3 t = (1.f - c) * unit;
+
+	return glm::mat3(
+		c + t.x * unit.x, t.x * unit.y + s * unit.z, t.x * unit.z - s * unit.y,
+		t.y * unit.x - s * unit.z, c + t.y * unit.y, t.y * unit.z + s * unit.x,
+		t.z * unit.x + s * unit.y, t.z * unit.y - s * unit.x, c + t.z * unit.z);
+}
+
+
+glm::mat3 EulerRotation(glm::vec3 degrees) {
+
+	glm::vec3 angles = glm::radians(degrees);
+	float cx = glm::cos(angles.x), sx = glm::sin(angles.x);
+	float cy = glm::cos(angles.y), sy = glm::sin(angles.y);
+	float cz = glm::cos(angles.z), sz = glm::sin(angles.z);
+
+	//Rx * Ry * Rz desarrollado, por columnas
+	return glm::mat3(
+		cy * cz, sx * sy * cz + cx * sz, -cx * sy * cz + sx * sz,
+		-cy * sz, -sx * sy * sz + cx * cz, cx * sy * sz + sx * cz,
+		sy, -sx * cy, cx * cy);
+}
+
+
+glm::mat4 ComposeModelMatrix(const glm::vec3& position, const glm::mat3& rotation, const glm::vec3& scale) {
+
+	//R * T * S: las columnas de R escaladas y la posicion rotada como traslacion
+	glm::mat4 model;
+	model[0] = glm::vec4(rotation[0] * scale.x, 0.f);
+	model[1] = glm::vec4(rotation[1] * scale.y, 0.f);
+	model[2] = glm::vec4(rotation[2] * scale.z, 0.f);
+	model[3] = glm::vec4(rotation[0] * position.x + rotation[1] * position.y + rotation[2] * position.z, 1.f);
+	return model;
+}
+
+
+glm::mat4 ComposeModelMatrix(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale) {
+
+	return ComposeModelMatrix(position, glm::mat3_cast(rotation), scale);
+}
+
+
+glm::mat4 ComposeModelMatrix(const glm::vec3& position, const glm::vec3& axis, float degrees, const glm::vec3& scale) {
+
+	return ComposeModelMatrix(position, AxisAngleRotation(axis, degrees), scale);
+}
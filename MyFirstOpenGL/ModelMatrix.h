@@ -0,0 +1,20 @@
+#pragma once
+
+#include <glm.hpp>
+#include <gtc/quaternion.hpp>
+
+//Composicion directa de matrices de modelo afines, sin construir ni multiplicar matrices 4x4 intermedias.
+//Todas devuelven lo mismo que rotation * translate(position) * scale(scale), el orden que usa la escena
+//(la rotacion tambien afecta a la posicion)
+
+//Rotacion 3x3 de degrees grados alrededor de axis (no hace falta normalizarlo). Un eje nulo no rota
+glm::mat3 AxisAngleRotation(glm::vec3 axis, float degrees);
+
+//Rotacion 3x3 equivalente a rotar X, despues Y y despues Z: Rx * Ry * Rz, en grados
+glm::mat3 EulerRotation(glm::vec3 degrees);
+
+glm::mat4 ComposeModelMatrix(const glm::vec3& position, const glm::mat3& rotation, const glm::vec3& scale);
+
+glm::mat4 ComposeModelMatrix(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+
+glm::mat4 ComposeModelMatrix(const glm::vec3& position, const glm::vec3& axis, float degrees, const glm::vec3& scale);
@@ -1,14 +0,0 @@
-#version 440 core
-
-layout(location = 0) in vec3 posicion;
-
-uniform mat4 translationMatrix;
-uniform mat4 rotationMatrix;
-uniform mat4 scaleMatrix;
-
-
-void main()
-{
-    mat4 matrix =  rotationMatrix * translationMatrix * scaleMatrix;
-    gl_Position = matrix * vec4(posicion, 1.0);
-}
\ No newline at end of file
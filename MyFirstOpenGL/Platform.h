@@ -0,0 +1,73 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <string>
+
+#ifdef HEADLESS
+#include <EGL/egl.h>
+#include <chrono>
+#else
+#include <GLFW/glfw3.h>
+#endif
+
+//Teclas que consulta el game loop
+enum PlatformKey
+{
+	KEY_1,
+	KEY_2,
+	KEY_3,
+	KEY_4,
+	KEY_M,
+	KEY_N
+};
+
+//Parametros para crear la ventana (o el contexto offscreen en modo headless)
+struct PlatformSettings
+{
+	int width = 0;
+	int height = 0;
+	const char* title = "";
+
+	//Solo headless: frames a dibujar antes de cerrar y archivo PPM donde guardar el ultimo
+	int maxFrames = 0;
+	std::string frameOutput;
+};
+
+//Ventana con GLFW o, compilando con HEADLESS, contexto EGL sin ventana que dibuja en un framebuffer propio
+struct Platform
+{
+	int width = 0;
+	int height = 0;
+	int frame = 0;
+
+#ifdef HEADLESS
+	EGLDisplay display = EGL_NO_DISPLAY;
+	EGLContext context = EGL_NO_CONTEXT;
+	GLuint framebuffer = 0;
+	GLuint colorBuffer = 0;
+	GLuint depthStencilBuffer = 0;
+	int maxFrames = 0;
+	std::string frameOutput;
+	std::chrono::steady_clock::time_point startTime;
+#else
+	GLFWwindow* window = nullptr;
+#endif
+};
+
+bool CreatePlatform(Platform& platform, const PlatformSettings& settings);
+
+bool PlatformShouldClose(Platform& platform);
+
+void PollPlatformEvents(Platform& platform);
+
+bool IsKeyPressed(Platform& platform, PlatformKey key);
+
+//Devuelve true mientras el boton izquierdo del raton esta pulsado y la posicion del cursor en pixeles del
+//framebuffer, los mismos que platform.width y height (origen arriba a la izquierda). Sin ventana siempre devuelve false
+bool IsMouseButtonPressed(Platform& platform, double& x, double& y);
+
+double GetPlatformTime(Platform& platform);
+
+void PresentFrame(Platform& platform);
+
+void DestroyPlatform(Platform& platform);
@@ -0,0 +1,131 @@
+#include "Platform.h"
+#include <iostream>
+
+
+void Resize_Window(GLFWwindow* window, int iFrameBufferWidth, int iFrameBufferHeight) {
+
+	//Definir nuevo tamaño del viewport
+	glViewport(0, 0, iFrameBufferWidth, iFrameBufferHeight);
+
+	Platform* platform = static_cast<Platform*>(glfwGetWindowUserPointer(window));
+	platform->width = iFrameBufferWidth;
+	platform->height = iFrameBufferHeight;
+}
+
+
+bool CreatePlatform(Platform& platform, const PlatformSettings& settings) {
+
+	platform.width = settings.width;
+	platform.height = settings.height;
+
+	//Inicializamos GLFW para gestionar ventanas e inputs
+	if (!glfwInit()) {
+		std::cout << "Fallo" << std::endl;
+		return false;
+	}
+
+	//Configuramos la ventana
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 4);
+	glfwWindowHint(GLFW_RESIZABLE, GL_TRUE);
+
+	//Inicializamos la ventana
+	platform.window = glfwCreateWindow(settings.width, settings.height, settings.title, NULL, NULL);
+	if (platform.window == nullptr) {
+		std::cout << "Fallo" << std::endl;
+		glfwTerminate();
+		return false;
+	}
+
+	//Asignamos función de callback para cuando el frame buffer es modificado
+	glfwSetWindowUserPointer(platform.window, &platform);
+	glfwSetFramebufferSizeCallback(platform.window, Resize_Window);
+
+	//En pantallas escaladas el framebuffer no mide lo mismo que la ventana: width y height siempre son los del framebuffer
+	glfwGetFramebufferSize(platform.window, &platform.width, &platform.height);
+
+	//Definimos espacio de trabajo
+	glfwMakeContextCurrent(platform.window);
+
+	//Permitimos a GLEW usar funcionalidades experimentales
+	glewExperimental = GL_TRUE;
+
+	//Inicializamos GLEW y controlamos errores
+	if (glewInit() != GLEW_OK) {
+		std::cout << "Fallo" << std::endl;
+		glfwTerminate();
+		return false;
+	}
+
+	return true;
+}
+
+
+bool PlatformShouldClose(Platform& platform) {
+
+	return glfwWindowShouldClose(platform.window);
+}
+
+
+void PollPlatformEvents(Platform& platform) {
+
+	//Pulleamos los eventos (botones, teclas, mouse...)
+	(void)platform;
+	glfwPollEvents();
+}
+
+
+bool IsKeyPressed(Platform& platform, PlatformKey key) {
+
+	int glfwKey = GLFW_KEY_UNKNOWN;
+	switch (key) {
+	case KEY_1: glfwKey = GLFW_KEY_1; break;
+	case KEY_2: glfwKey = GLFW_KEY_2; break;
+	case KEY_3: glfwKey = GLFW_KEY_3; break;
+	case KEY_4: glfwKey = GLFW_KEY_4; break;
+	case KEY_M: glfwKey = GLFW_KEY_M; break;
+	case KEY_N: glfwKey = GLFW_KEY_N; break;
+	}
+
+	return glfwGetKey(platform.window, glfwKey) == GLFW_PRESS;
+}
+
+
+bool IsMouseButtonPressed(Platform& platform, double& x, double& y) {
+
+	//GLFW da el cursor en coordenadas de ventana, lo pasamos a pixeles del framebuffer como platform.width y height
+	glfwGetCursorPos(platform.window, &x, &y);
+	int windowWidth, windowHeight;
+	glfwGetWindowSize(platform.window, &windowWidth, &windowHeight);
+	if (windowWidth > 0 && windowHeight > 0) {
+		x *= static_cast<double>(platform.width) / windowWidth;
+		y *= static_cast<double>(platform.height) / windowHeight;
+	}
+	return glfwGetMouseButton(platform.window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+}
+
+
+double GetPlatformTime(Platform& platform) {
+
+	(void)platform;
+	return glfwGetTime();
+}
+
+
+void PresentFrame(Platform& platform) {
+
+	//Cambiamos buffers
+	glFlush();
+	glfwSwapBuffers(platform.window);
+	platform.frame++;
+}
+
+
+void DestroyPlatform(Platform& platform) {
+
+	//Finalizamos GLFW
+	glfwDestroyWindow(platform.window);
+	platform.window = nullptr;
+	glfwTerminate();
+}
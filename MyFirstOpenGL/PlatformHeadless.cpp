@@ -0,0 +1,219 @@
+#include "Platform.h"
+#include <EGL/eglext.h>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+
+//Display EGL sin ventana: primero el de Mesa sin superficie (llvmpipe en maquinas sin GPU) y si no el de por defecto
+EGLDisplay GetHeadlessDisplay() {
+
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+		(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+#ifdef EGL_PLATFORM_SURFACELESS_MESA
+	if (getPlatformDisplay != nullptr) {
+		EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+		if (display != EGL_NO_DISPLAY)
+			return display;
+	}
+#endif
+
+	return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+
+bool CreatePlatform(Platform& platform, const PlatformSettings& settings) {
+
+	platform.width = settings.width;
+	platform.height = settings.height;
+	platform.maxFrames = settings.maxFrames;
+	platform.frameOutput = settings.frameOutput;
+
+	platform.display = GetHeadlessDisplay();
+	if (platform.display == EGL_NO_DISPLAY || !eglInitialize(platform.display, nullptr, nullptr)) {
+		std::cerr << "No se ha podido iniciar EGL" << std::endl;
+		return false;
+	}
+
+	//Pedimos OpenGL de escritorio, no OpenGL ES
+	if (!eglBindAPI(EGL_OPENGL_API)) {
+		std::cerr << "EGL no soporta OpenGL de escritorio" << std::endl;
+		eglTerminate(platform.display);
+		return false;
+	}
+
+	const EGLint configAttributes[] = {
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8,
+		EGL_GREEN_SIZE, 8,
+		EGL_BLUE_SIZE, 8,
+		EGL_NONE
+	};
+
+	EGLConfig config;
+	EGLint configCount = 0;
+	if (!eglChooseConfig(platform.display, configAttributes, &config, 1, &configCount) || configCount == 0) {
+		std::cerr << "No hay ninguna configuracion EGL compatible" << std::endl;
+		eglTerminate(platform.display);
+		return false;
+	}
+
+	//Mismo contexto que en la version con ventana: 4.4 core
+	const EGLint contextAttributes[] = {
+		EGL_CONTEXT_MAJOR_VERSION, 4,
+		EGL_CONTEXT_MINOR_VERSION, 4,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE
+	};
+
+	platform.context = eglCreateContext(platform.display, config, EGL_NO_CONTEXT, contextAttributes);
+	if (platform.context == EGL_NO_CONTEXT) {
+		std::cerr << "No se ha podido crear un contexto OpenGL 4.4 core" << std::endl;
+		eglTerminate(platform.display);
+		return false;
+	}
+
+	//Sin superficie: todo se dibuja en el framebuffer que creamos abajo
+	if (!eglMakeCurrent(platform.display, EGL_NO_SURFACE, EGL_NO_SURFACE, platform.context)) {
+		std::cerr << "No se ha podido activar el contexto EGL" << std::endl;
+		eglDestroyContext(platform.display, platform.context);
+		eglTerminate(platform.display);
+		return false;
+	}
+
+	//Permitimos a GLEW usar funcionalidades experimentales
+	glewExperimental = GL_TRUE;
+
+	//Un GLEW compilado para GLX carga las funciones de OpenGL y despues falla al no encontrar display X11;
+	//en ese caso el contexto ya es utilizable
+	GLenum glewResult = glewInit();
+	if (glewResult != GLEW_OK && glewResult != GLEW_ERROR_NO_GLX_DISPLAY) {
+		std::cerr << "Fallo al iniciar GLEW: " << glewGetErrorString(glewResult) << std::endl;
+		DestroyPlatform(platform);
+		return false;
+	}
+
+	//Framebuffer propio que hace de ventana
+	glGenRenderbuffers(1, &platform.colorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, platform.colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, platform.width, platform.height);
+
+	glGenRenderbuffers(1, &platform.depthStencilBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, platform.depthStencilBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, platform.width, platform.height);
+
+	glGenFramebuffers(1, &platform.framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, platform.framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, platform.colorBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, platform.depthStencilBuffer);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+		std::cerr << "El framebuffer offscreen esta incompleto" << std::endl;
+		DestroyPlatform(platform);
+		return false;
+	}
+
+	glViewport(0, 0, platform.width, platform.height);
+
+	platform.startTime = std::chrono::steady_clock::now();
+	return true;
+}
+
+
+bool PlatformShouldClose(Platform& platform) {
+
+	return platform.frame >= platform.maxFrames;
+}
+
+
+void PollPlatformEvents(Platform& platform) {
+
+	//Sin ventana no hay eventos
+	(void)platform;
+}
+
+
+bool IsKeyPressed(Platform& platform, PlatformKey key) {
+
+	//Sin teclado: el render se queda con la configuracion inicial
+	(void)platform;
+	(void)key;
+	return false;
+}
+
+
+bool IsMouseButtonPressed(Platform& platform, double& x, double& y) {
+
+	//Sin raton: no se selecciona nada
+	(void)platform;
+	x = 0.0;
+	y = 0.0;
+	return false;
+}
+
+
+double GetPlatformTime(Platform& platform) {
+
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - platform.startTime).count();
+}
+
+
+//Guarda el framebuffer en formato PPM (P6), girandolo porque OpenGL empieza por la fila de abajo
+bool SaveFramePPM(Platform& platform, const std::string& filePath) {
+
+	std::vector<unsigned char> pixels((size_t)platform.width * platform.height * 3);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, platform.width, platform.height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+	FILE* file = std::fopen(filePath.c_str(), "wb");
+	if (file == nullptr)
+		return false;
+
+	std::fprintf(file, "P6\n%d %d\n255\n", platform.width, platform.height);
+
+	size_t rowSize = (size_t)platform.width * 3;
+	for (int row = platform.height - 1; row >= 0; row--)
+		std::fwrite(pixels.data() + row * rowSize, 1, rowSize, file);
+
+	return std::fclose(file) == 0;
+}
+
+
+void PresentFrame(Platform& platform) {
+
+	//No hay swap: esperamos a la GPU para que el tiempo por frame sea real
+	glFinish();
+	platform.frame++;
+
+	if (platform.frame == platform.maxFrames && !platform.frameOutput.empty()) {
+		if (SaveFramePPM(platform, platform.frameOutput))
+			std::cout << "Ultimo frame guardado en " << platform.frameOutput << std::endl;
+		else
+			std::cerr << "No se ha podido guardar " << platform.frameOutput << std::endl;
+	}
+}
+
+
+void DestroyPlatform(Platform& platform) {
+
+	if (platform.frame > 0) {
+		double seconds = GetPlatformTime(platform);
+		std::cout << "Headless: " << platform.frame << " frames en " << seconds * 1000.0 << " ms ("
+			<< seconds * 1000.0 / platform.frame << " ms/frame)" << std::endl;
+	}
+
+	if (platform.framebuffer != 0) {
+		glDeleteFramebuffers(1, &platform.framebuffer);
+		glDeleteRenderbuffers(1, &platform.colorBuffer);
+		glDeleteRenderbuffers(1, &platform.depthStencilBuffer);
+		platform.framebuffer = 0;
+	}
+
+	eglMakeCurrent(platform.display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	eglDestroyContext(platform.display, platform.context);
+	eglTerminate(platform.display);
+	platform.context = EGL_NO_CONTEXT;
+	platform.display = EGL_NO_DISPLAY;
+}
@@ -0,0 +1,293 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+
+double ProfilerMilliseconds(const Profiler& profiler) {
+
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - profiler.startTime).count();
+}
+
+
+Profiler CreateProfiler(bool enabled) {
+
+	Profiler profiler;
+	profiler.enabled = enabled;
+	profiler.startTime = std::chrono::steady_clock::now();
+	return profiler;
+}
+
+
+ProfileFrame* FindProfileFrame(Profiler& profiler, long long index) {
+
+	if (profiler.frames.empty() || index < profiler.frames.front().index || index > profiler.frames.back().index)
+		return nullptr;
+
+	return &profiler.frames[static_cast<size_t>(index - profiler.frames.front().index)];
+}
+
+
+//Lee las consultas que ya tienen resultado sin esperar a la GPU
+void CollectGpuQueries(Profiler& profiler, bool wait) {
+
+	size_t kept = 0;
+	for (size_t i = 0; i < profiler.pendingQueries.size(); i++) {
+
+		PendingGpuQuery& pending = profiler.pendingQueries[i];
+
+		GLint available = GL_FALSE;
+		if (wait)
+			available = GL_TRUE;
+		else if (profiler.frameIndex - pending.frame >= PROFILER_QUERY_LATENCY)
+			glGetQueryObjectiv(pending.query, GL_QUERY_RESULT_AVAILABLE, &available);
+
+		if (!available) {
+			profiler.pendingQueries[kept++] = pending;
+			continue;
+		}
+
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(pending.query, GL_QUERY_RESULT, &nanoseconds);
+
+		//El frame puede haber salido ya del historial
+		ProfileFrame* frame = FindProfileFrame(profiler, pending.frame);
+		if (frame != nullptr)
+			frame->samples[pending.sample].gpuMilliseconds = nanoseconds / 1000000.0;
+
+		profiler.freeQueries.push_back(pending.query);
+	}
+	profiler.pendingQueries.resize(kept);
+}
+
+
+void BeginProfilerFrame(Profiler& profiler) {
+
+	if (!profiler.enabled)
+		return;
+
+	CollectGpuQueries(profiler, false);
+
+	if (profiler.frames.size() == PROFILER_HISTORY_FRAMES)
+		profiler.frames.pop_front();
+
+	ProfileFrame frame;
+	frame.index = profiler.frameIndex;
+	frame.start = ProfilerMilliseconds(profiler);
+	profiler.frames.push_back(std::move(frame));
+	profiler.frameOpen = true;
+}
+
+
+void EndProfilerFrame(Profiler& profiler) {
+
+	if (!profiler.enabled || !profiler.frameOpen)
+		return;
+
+	//Cerramos los scopes que se hayan quedado abiertos
+	while (!profiler.openScopes.empty())
+		EndProfileScope(profiler);
+
+	ProfileFrame& frame = profiler.frames.back();
+	frame.milliseconds = ProfilerMilliseconds(profiler) - frame.start;
+
+	profiler.frameOpen = false;
+	profiler.frameIndex++;
+}
+
+
+void BeginProfileScope(Profiler& profiler, const char* name, bool measureGpu) {
+
+	if (!profiler.enabled || !profiler.frameOpen)
+		return;
+
+	ProfileFrame& frame = profiler.frames.back();
+
+	ProfileSample sample;
+	sample.name = name;
+	sample.depth = static_cast<int>(profiler.openScopes.size());
+	sample.cpuStart = ProfilerMilliseconds(profiler);
+
+	//GL_TIME_ELAPSED no admite consultas anidadas
+	bool gpu = measureGpu && !profiler.gpuQueryActive;
+	if (gpu) {
+		GLuint query;
+		if (profiler.freeQueries.empty()) {
+			glGenQueries(1, &query);
+		}
+		else {
+			query = profiler.freeQueries.back();
+			profiler.freeQueries.pop_back();
+		}
+
+		glBeginQuery(GL_TIME_ELAPSED, query);
+		profiler.gpuQueryActive = true;
+		profiler.pendingQueries.push_back({ query, frame.index, frame.samples.size() });
+	}
+
+	profiler.openScopes.push_back(frame.samples.size());
+	profiler.openScopesGpu.push_back(gpu);
+	frame.samples.push_back(sample);
+}
+
+
+void EndProfileScope(Profiler& profiler) {
+
+	if (!profiler.enabled || profiler.openScopes.empty())
+		return;
+
+	if (profiler.openScopesGpu.back()) {
+		glEndQuery(GL_TIME_ELAPSED);
+		profiler.gpuQueryActive = false;
+	}
+
+	ProfileSample& sample = profiler.frames.back().samples[profiler.openScopes.back()];
+	sample.cpuMilliseconds = ProfilerMilliseconds(profiler) - sample.cpuStart;
+
+	profiler.openScopes.pop_back();
+	profiler.openScopesGpu.pop_back();
+}
+
+
+//Percentil por el metodo del rango mas cercano; ordena los valores
+double Percentile(std::vector<double>& values, double percent) {
+
+	if (values.empty())
+		return 0.0;
+
+	std::sort(values.begin(), values.end());
+	size_t rank = static_cast<size_t>(percent / 100.0 * (values.size() - 1) + 0.5);
+	return values[std::min(rank, values.size() - 1)];
+}
+
+
+void PrintPercentiles(const char* label, std::vector<double>& values) {
+
+	if (values.empty())
+		return;
+
+	std::printf("  %-30s p50 %8.3f  p95 %8.3f  p99 %8.3f  (%zu muestras)\n", label,
+		Percentile(values, 50.0), Percentile(values, 95.0), Percentile(values, 99.0), values.size());
+}
+
+
+void PrintProfilerReport(const Profiler& profiler) {
+
+	if (!profiler.enabled || profiler.frames.empty())
+		return;
+
+	//Nombres de los scopes en orden de aparicion
+	std::vector<const char*> names;
+	std::vector<double> frameTimes;
+	for (const ProfileFrame& frame : profiler.frames) {
+		frameTimes.push_back(frame.milliseconds);
+		for (const ProfileSample& sample : frame.samples) {
+			bool known = false;
+			for (const char* name : names)
+				known = known || std::strcmp(name, sample.name) == 0;
+			if (!known)
+				names.push_back(sample.name);
+		}
+	}
+
+	std::printf("Profiler: ultimos %zu frames (ms)\n", profiler.frames.size());
+	PrintPercentiles("Frame", frameTimes);
+
+	for (const char* name : names) {
+
+		//Cada scope suma todas sus apariciones dentro del frame
+		std::vector<double> cpuTimes, gpuTimes;
+		for (const ProfileFrame& frame : profiler.frames) {
+			double cpu = 0.0, gpu = 0.0;
+			bool found = false, gpuFound = false;
+			for (const ProfileSample& sample : frame.samples) {
+				if (std::strcmp(sample.name, name) != 0)
+					continue;
+				found = true;
+				cpu += sample.cpuMilliseconds;
+				if (sample.gpuMilliseconds >= 0.0) {
+					gpuFound = true;
+					gpu += sample.gpuMilliseconds;
+				}
+			}
+			if (found)
+				cpuTimes.push_back(cpu);
+			if (gpuFound)
+				gpuTimes.push_back(gpu);
+		}
+
+		std::string cpuLabel = std::string(name) + " (CPU)";
+		std::string gpuLabel = std::string(name) + " (GPU)";
+		PrintPercentiles(cpuLabel.c_str(), cpuTimes);
+		PrintPercentiles(gpuLabel.c_str(), gpuTimes);
+	}
+}
+
+
+void WriteJsonString(FILE* file, const char* text) {
+
+	std::fputc('"', file);
+	for (const char* character = text; *character != '\0'; character++) {
+		if (*character == '"' || *character == '\\')
+			std::fputc('\\', file);
+		std::fputc(*character, file);
+	}
+	std::fputc('"', file);
+}
+
+
+bool WriteChromeTrace(const Profiler& profiler, const std::string& filePath) {
+
+	FILE* file = std::fopen(filePath.c_str(), "w");
+	if (file == nullptr)
+		return false;
+
+	//Eventos completos ("X") en microsegundos. Hilo 1: CPU; hilo 2: GPU, colocado en el inicio de CPU del scope
+	//porque GL_TIME_ELAPSED solo da la duracion
+	std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n");
+	std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}");
+
+	for (const ProfileFrame& frame : profiler.frames) {
+		std::fprintf(file, ",\n{\"name\":\"Frame %lld\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+			frame.index, frame.start * 1000.0, frame.milliseconds * 1000.0);
+
+		for (const ProfileSample& sample : frame.samples) {
+			std::fprintf(file, ",\n{\"name\":");
+			WriteJsonString(file, sample.name);
+			std::fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}", sample.cpuStart * 1000.0, sample.cpuMilliseconds * 1000.0);
+
+			if (sample.gpuMilliseconds >= 0.0) {
+				std::fprintf(file, ",\n{\"name\":");
+				WriteJsonString(file, sample.name);
+				std::fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":2,\"ts\":%.3f,\"dur\":%.3f}", sample.cpuStart * 1000.0, sample.gpuMilliseconds * 1000.0);
+			}
+		}
+	}
+
+	std::fprintf(file, "\n]}\n");
+	return std::fclose(file) == 0;
+}
+
+
+void ResolveProfilerQueries(Profiler& profiler) {
+
+	if (profiler.enabled)
+		CollectGpuQueries(profiler, true);
+}
+
+
+void DestroyProfiler(Profiler& profiler) {
+
+	if (!profiler.enabled)
+		return;
+
+	//Las consultas sin leer se esperan antes de borrarlas
+	CollectGpuQueries(profiler, true);
+
+	if (!profiler.freeQueries.empty())
+		glDeleteQueries(static_cast<GLsizei>(profiler.freeQueries.size()), profiler.freeQueries.data());
+	profiler.freeQueries.clear();
+	profiler.frames.clear();
+}
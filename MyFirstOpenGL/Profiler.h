@@ -0,0 +1,81 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <chrono>
+#include <deque>
+#include <string>
+#include <vector>
+
+//Frames que esperamos antes de leer una consulta de tiempo de la GPU, para no parar el pipeline
+#define PROFILER_QUERY_LATENCY 4
+
+//Frames que se guardan para calcular percentiles y exportar la traza
+#define PROFILER_HISTORY_FRAMES 1000
+
+//Tiempo medido de un scope. Los tiempos de CPU son milisegundos desde que se creo el profiler.
+//gpuMilliseconds vale -1 si el scope no mide GPU o si su consulta aun no ha llegado
+struct ProfileSample
+{
+	const char* name = "";
+	int depth = 0;
+	double cpuStart = 0.0;
+	double cpuMilliseconds = 0.0;
+	double gpuMilliseconds = -1.0;
+};
+
+struct ProfileFrame
+{
+	long long index = 0;
+	double start = 0.0;
+	double milliseconds = 0.0;
+	std::vector<ProfileSample> samples;
+};
+
+//Consulta GL_TIME_ELAPSED lanzada y pendiente de leer
+struct PendingGpuQuery
+{
+	GLuint query = 0;
+	long long frame = 0;
+	size_t sample = 0;
+};
+
+//Profiler de scopes con nombre. En CPU usa steady_clock; en GPU consultas GL_TIME_ELAPSED que se leen
+//PROFILER_QUERY_LATENCY frames despues. Las consultas de GPU no se pueden anidar: solo mide GPU el scope
+//mas externo que lo pida
+struct Profiler
+{
+	bool enabled = false;
+	std::chrono::steady_clock::time_point startTime;
+
+	std::deque<ProfileFrame> frames;
+	long long frameIndex = 0;
+	bool frameOpen = false;
+
+	std::vector<size_t> openScopes;
+	std::vector<bool> openScopesGpu;
+	bool gpuQueryActive = false;
+
+	std::vector<GLuint> freeQueries;
+	std::vector<PendingGpuQuery> pendingQueries;
+};
+
+Profiler CreateProfiler(bool enabled);
+
+void BeginProfilerFrame(Profiler& profiler);
+
+void EndProfilerFrame(Profiler& profiler);
+
+void BeginProfileScope(Profiler& profiler, const char* name, bool measureGpu = false);
+
+void EndProfileScope(Profiler& profiler);
+
+//Espera a las consultas de GPU pendientes; se llama al terminar, antes del informe
+void ResolveProfilerQueries(Profiler& profiler);
+
+//Muestra p50/p95/p99 del frame y de cada scope sobre los frames guardados
+void PrintProfilerReport(const Profiler& profiler);
+
+//Exporta los frames guardados en formato Chrome trace (chrome://tracing o Perfetto)
+bool WriteChromeTrace(const Profiler& profiler, const std::string& filePath);
+
+void DestroyProfiler(Profiler& profiler);
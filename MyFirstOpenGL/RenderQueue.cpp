@@ -0,0 +1,183 @@
+#include "RenderQueue.h"
+#include <algorithm>
+
+
+RenderQueue CreateRenderQueue(GLuint transformBinding, GLuint parameterBinding) {
+
+	RenderQueue queue;
+	queue.transformBinding = transformBinding;
+	queue.parameterBinding = parameterBinding;
+	return queue;
+}
+
+
+void ClearRenderQueue(RenderQueue& queue) {
+
+	queue.materials.clear();
+	queue.commands.clear();
+	queue.keys.clear();
+	queue.order.clear();
+}
+
+
+void AddMaterialUniform(Material& material, GLint location, GLint components, const glm::vec4& value) {
+
+	//Los uniforms que el programa no usa tienen localizacion -1 y no hace falta subirlos
+	if (location < 0 || material.uniformCount >= MATERIAL_MAX_UNIFORMS)
+		return;
+
+	MaterialUniform& uniform = material.uniforms[material.uniformCount++];
+	uniform.location = location;
+	uniform.components = components;
+	uniform.value = value;
+}
+
+
+void SetMaterialUniform(Material& material, GLint location, float value) {
+
+	AddMaterialUniform(material, location, 1, glm::vec4(value, 0.f, 0.f, 0.f));
+}
+
+
+void SetMaterialUniform(Material& material, GLint location, const glm::vec2& value) {
+
+	AddMaterialUniform(material, location, 2, glm::vec4(value, 0.f, 0.f));
+}
+
+
+std::uint32_t AddMaterial(RenderQueue& queue, const Material& material) {
+
+	queue.materials.push_back(material);
+	return static_cast<std::uint32_t>(queue.materials.size() - 1);
+}
+
+
+std::uint64_t MakeSortKey(std::uint32_t layer, GLuint program, GLuint vertexArray, std::uint32_t material, float depth) {
+
+	//En double para que depth = 1 no se redondee por encima del ultimo valor de 24 bits
+	const double depthScale = static_cast<double>((1u << SORT_KEY_DEPTH_BITS) - 1);
+	std::uint64_t depthBits = static_cast<std::uint64_t>(std::clamp(static_cast<double>(depth), 0.0, 1.0) * depthScale);
+
+	return (static_cast<std::uint64_t>(layer & 0xFu) << SORT_KEY_LAYER_SHIFT)
+		| (static_cast<std::uint64_t>(program & 0xFFFu) << SORT_KEY_PROGRAM_SHIFT)
+		| (static_cast<std::uint64_t>(vertexArray & 0xFFFFu) << SORT_KEY_VAO_SHIFT)
+		| (static_cast<std::uint64_t>(material & 0xFFu) << SORT_KEY_MATERIAL_SHIFT)
+		| depthBits;
+}
+
+
+void PushRenderCommand(RenderQueue& queue, const RenderCommand& command) {
+
+	queue.keys.push_back(MakeSortKey(command.layer, command.program, command.vertexArray, command.material, command.depth));
+	queue.order.push_back(static_cast<std::uint32_t>(queue.commands.size()));
+	queue.commands.push_back(command);
+}
+
+
+void RadixSortKeys(std::vector<std::uint64_t>& keys, std::vector<std::uint32_t>& values,
+	std::vector<std::uint64_t>& keyScratch, std::vector<std::uint32_t>& valueScratch) {
+
+	const int passCount = 64 / RADIX_SORT_BITS;
+	const int bucketCount = 1 << RADIX_SORT_BITS;
+	const std::uint64_t digitMask = bucketCount - 1;
+
+	size_t count = keys.size();
+	if (count < 2)
+		return;
+
+	keyScratch.resize(count);
+	valueScratch.resize(count);
+
+	//Los histogramas de todas las pasadas salen de una sola lectura de las claves
+	size_t histograms[passCount][bucketCount] = {};
+	for (size_t i = 0; i < count; i++) {
+		std::uint64_t key = keys[i];
+		for (int pass = 0; pass < passCount; pass++)
+			histograms[pass][(key >> (pass * RADIX_SORT_BITS)) & digitMask]++;
+	}
+
+	for (int pass = 0; pass < passCount; pass++) {
+		int shift = pass * RADIX_SORT_BITS;
+		size_t* histogram = histograms[pass];
+
+		//Si todas las claves comparten digito la pasada dejaria el mismo orden
+		if (histogram[(keys[0] >> shift) & digitMask] == count)
+			continue;
+
+		size_t offset = 0;
+		for (int bucket = 0; bucket < bucketCount; bucket++) {
+			size_t bucketSize = histogram[bucket];
+			histogram[bucket] = offset;
+			offset += bucketSize;
+		}
+
+		for (size_t i = 0; i < count; i++) {
+			size_t destination = histogram[(keys[i] >> shift) & digitMask]++;
+			keyScratch[destination] = keys[i];
+			valueScratch[destination] = values[i];
+		}
+
+		keys.swap(keyScratch);
+		values.swap(valueScratch);
+	}
+}
+
+
+void SortRenderQueue(RenderQueue& queue) {
+
+	RadixSortKeys(queue.keys, queue.order, queue.keyScratch, queue.orderScratch);
+}
+
+
+void ApplyMaterial(const Material& material) {
+
+	for (int i = 0; i < material.uniformCount; i++) {
+		const MaterialUniform& uniform = material.uniforms[i];
+		switch (uniform.components) {
+		case 1:
+			glUniform1f(uniform.location, uniform.value.x);
+			break;
+		case 2:
+			glUniform2f(uniform.location, uniform.value.x, uniform.value.y);
+			break;
+		case 3:
+			glUniform3f(uniform.location, uniform.value.x, uniform.value.y, uniform.value.z);
+			break;
+		default:
+			glUniform4f(uniform.location, uniform.value.x, uniform.value.y, uniform.value.z, uniform.value.w);
+			break;
+		}
+	}
+}
+
+
+void ExecuteRenderQueue(RenderQueue& queue, GLStateCache& cache) {
+
+	GLuint currentProgram = STATE_CACHE_UNKNOWN;
+	std::uint32_t currentMaterial = STATE_CACHE_UNKNOWN;
+
+	for (std::uint32_t index : queue.order) {
+		const RenderCommand& command = queue.commands[index];
+		const Material& material = queue.materials[command.material];
+
+		CachedUseProgram(cache, command.program);
+
+		//Los uniforms son estado del programa: con el mismo programa y material ya estan puestos
+		if (command.program != currentProgram || command.material != currentMaterial) {
+			ApplyMaterial(material);
+			cache.issuedCalls += material.uniformCount;
+			currentProgram = command.program;
+			currentMaterial = command.material;
+		}
+		else {
+			cache.skippedCalls += material.uniformCount;
+		}
+
+		CachedBindVertexArray(cache, command.vertexArray);
+		CachedBindDrawIndirectBuffer(cache, command.indirectBuffer);
+		CachedBindBufferRange(cache, GL_SHADER_STORAGE_BUFFER, queue.transformBinding, command.transforms);
+		CachedBindBufferRange(cache, GL_SHADER_STORAGE_BUFFER, queue.parameterBinding, command.parameters);
+
+		glMultiDrawElementsIndirect(command.mode, command.indexType, (GLvoid*)command.indirectOffset, command.drawCount, 0);
+	}
+}
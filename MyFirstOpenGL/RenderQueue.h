@@ -0,0 +1,103 @@
+#pragma once
+
+#include "StateCache.h"
+#include <GL/glew.h>
+#include <glm.hpp>
+#include <cstdint>
+#include <vector>
+
+//Campos de la clave de orden de 64 bits, de mas a menos significativo: capa (4 bits), programa (12), VAO (16),
+//material (8) y profundidad (24). La capa fija el orden entre pasadas (sin depth test es el orden de pintado).
+//Dentro de una capa cambiar de programa es lo mas caro, asi que sus draws quedan juntos y se agrupan por VAO y
+//material. La profundidad ordena de cerca a lejos
+#define SORT_KEY_LAYER_SHIFT 60
+#define SORT_KEY_PROGRAM_SHIFT 48
+#define SORT_KEY_VAO_SHIFT 32
+#define SORT_KEY_MATERIAL_SHIFT 24
+#define SORT_KEY_DEPTH_BITS 24
+
+//Bits que ordena cada pasada del radix sort (256 cubetas)
+#define RADIX_SORT_BITS 8
+
+//Uniforms que puede fijar un material
+#define MATERIAL_MAX_UNIFORMS 4
+
+//Uniform float, vec2, vec3 o vec4 de un material
+struct MaterialUniform
+{
+	GLint location = -1;
+	GLint components = 0;
+	glm::vec4 value = glm::vec4(0.f);
+};
+
+//Valores de los uniforms de un programa. Se suben al empezar cada grupo de draws con el mismo programa y material
+struct Material
+{
+	MaterialUniform uniforms[MATERIAL_MAX_UNIFORMS];
+	int uniformCount = 0;
+};
+
+//Draw indirecto ya escrito en su buffer, con todo el estado que necesita para lanzarse
+struct RenderCommand
+{
+	GLuint program = 0;
+	GLuint vertexArray = 0;
+	GLenum mode = GL_TRIANGLES;
+	GLenum indexType = GL_UNSIGNED_INT;
+	GLuint indirectBuffer = 0;
+	GLintptr indirectOffset = 0;
+	GLsizei drawCount = 0;
+
+	//SSBO de matrices de modelo y de primera matriz de cada draw que leen los vertex shaders
+	BufferRange transforms;
+	BufferRange parameters;
+
+	//Capa, indice en RenderQueue::materials y profundidad en [0, 1] (0 es el plano cercano)
+	std::uint32_t layer = 0;
+	std::uint32_t material = 0;
+	float depth = 0.f;
+};
+
+//Draws de un frame en cualquier orden. Se ordenan por su clave y se lanzan pasando el estado por la cache
+struct RenderQueue
+{
+	GLuint transformBinding = 0;
+	GLuint parameterBinding = 0;
+
+	std::vector<Material> materials;
+	std::vector<RenderCommand> commands;
+
+	//Claves y, tras ordenar, indices de los comandos en orden de dibujo. Los scratch los usa el radix sort
+	std::vector<std::uint64_t> keys;
+	std::vector<std::uint32_t> order;
+	std::vector<std::uint64_t> keyScratch;
+	std::vector<std::uint32_t> orderScratch;
+};
+
+//transformBinding y parameterBinding son los puntos de binding de los SSBO ObjectTransforms y DrawParameters
+RenderQueue CreateRenderQueue(GLuint transformBinding, GLuint parameterBinding);
+
+//Vacia la cola sin liberar memoria, al empezar cada frame
+void ClearRenderQueue(RenderQueue& queue);
+
+void SetMaterialUniform(Material& material, GLint location, float value);
+
+void SetMaterialUniform(Material& material, GLint location, const glm::vec2& value);
+
+//Devuelve el indice del material para RenderCommand::material
+std::uint32_t AddMaterial(RenderQueue& queue, const Material& material);
+
+std::uint64_t MakeSortKey(std::uint32_t layer, GLuint program, GLuint vertexArray, std::uint32_t material, float depth);
+
+void PushRenderCommand(RenderQueue& queue, const RenderCommand& command);
+
+//Radix sort LSD estable de keys arrastrando values, RADIX_SORT_BITS por pasada. Se salta las pasadas en las que
+//todas las claves tienen el mismo digito, asi que con pocos programas y materiales casi solo ordena la profundidad
+void RadixSortKeys(std::vector<std::uint64_t>& keys, std::vector<std::uint32_t>& values,
+	std::vector<std::uint64_t>& keyScratch, std::vector<std::uint32_t>& valueScratch);
+
+void SortRenderQueue(RenderQueue& queue);
+
+//Lanza los comandos en el orden de la ultima SortRenderQueue. Programa, VAO, buffer indirecto y SSBO pasan por
+//la cache, y los uniforms del material solo se suben cuando cambia el programa o el material
+void ExecuteRenderQueue(RenderQueue& queue, GLStateCache& cache);
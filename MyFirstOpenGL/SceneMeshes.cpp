@@ -0,0 +1,76 @@
+#include "SceneMeshes.h"
+#include "MeshFile.h"
+#include <iostream>
+#include <filesystem>
+
+
+//Posicion X, Y y Z de cada punto de la tira
+const GLfloat hexa[] =
+{
+	-0.8f, +0.2f, -0.2f, // 3
+	-0.4f, +0.2f, -0.2f, // 2
+	-0.8f, -0.2f, -0.2f, // 6
+	-0.4f, -0.2f, -0.2f, // 7
+	-0.4f, -0.2f, +0.2f, // 4
+	-0.4f, +0.2f, -0.2f, // 2
+	-0.4f, +0.2f, +0.2f, // 0
+	-0.8f, +0.2f, -0.2f, // 3
+	-0.8f, +0.2f, +0.2f, // 1
+	-0.8f, -0.2f, -0.2f, // 6
+	-0.8f, -0.2f, +0.2f, // 5
+	-0.4f, -0.2f, +0.2f, // 4
+	-0.8f, +0.2f, +0.2f, // 1
+	-0.4f, +0.2f, +0.2f  // 0
+};
+
+const GLfloat penta[] =
+{
+	+0.4f, 0.0f,-0.5f, //1
+	+0.8f, 0.0f, -0.5f, //2
+	+0.4f, 0.0f, 0.0f, //3
+	+0.8f, 0.0f, 0.0f,//4
+	+0.6f, +0.3f, -0.25f,//5
+	+0.8f, 0.0f, -0.5f, //2
+	+0.4f, 0.0f,-0.5f, //1
+	+0.4f, 0.0f, 0.0f, //3
+	+0.6f, +0.3f, -0.25f,//5
+};
+
+
+//Las tiras repiten posiciones: las quitamos y dejamos los vertices en el orden en que se leen
+MeshData BuildStripMesh(const GLfloat* positions, size_t vertexCount) {
+
+	MeshBuilder builder;
+	AddTriangleStrip(builder, positions, vertexCount);
+	OptimizeVertexFetch(builder.mesh);
+	return builder.mesh;
+}
+
+
+MeshData BuildHexaedroMesh() {
+
+	return BuildStripMesh(hexa, sizeof(hexa) / (3 * sizeof(GLfloat)));
+}
+
+
+MeshData BuildPentaedroMesh() {
+
+	return BuildStripMesh(penta, sizeof(penta) / (3 * sizeof(GLfloat)));
+}
+
+
+bool BakeSceneMeshes(const std::string& directory) {
+
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+	if (error) {
+		std::cerr << "No se ha podido crear el directorio: " << directory << std::endl;
+		return false;
+	}
+
+	if (!WriteMeshFile(directory + "/Hexaedro.mesh", BuildHexaedroMesh()) || !WriteMeshFile(directory + "/Pentaedro.mesh", BuildPentaedroMesh()))
+		return false;
+
+	std::cout << "Mallas de la escena escritas en " << directory << std::endl;
+	return true;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "Mesh.h"
+#include <string>
+
+//Geometria original de la escena: tiras de triangulos escritas a mano. Hexaedro.mesh y Pentaedro.mesh salen
+//de aqui con --bake-meshes, asi que cualquier cambio en las mallas se hace en SceneMeshes.cpp y se vuelve a hornear
+
+MeshData BuildHexaedroMesh();
+
+MeshData BuildPentaedroMesh();
+
+//Escribe Hexaedro.mesh y Pentaedro.mesh en directory (--bake-meshes directorio). Crea el directorio si no existe
+bool BakeSceneMeshes(const std::string& directory);
@@ -0,0 +1,642 @@
+#include "Shader.h"
+#include "File.h"
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <filesystem>
+#include <cstdio>
+#include <thread>
+
+
+const char* ShaderStageName(GLenum stage) {
+
+	switch (stage) {
+	case GL_VERTEX_SHADER:
+		return "vertex";
+	case GL_GEOMETRY_SHADER:
+		return "geometry";
+	case GL_FRAGMENT_SHADER:
+		return "fragment";
+	case GL_COMPUTE_SHADER:
+		return "compute";
+	default:
+		return "desconocido";
+	}
+}
+
+
+GLuint SubmitShader(GLenum stage, std::string_view source) {
+
+	// Crear un shader de la etapa indicada
+	GLuint shader = glCreateShader(stage);
+
+	//Vinculamos el shader con su código fuente, pasando la longitud para no necesitar un '\0' final
+	const char* cShaderSource = source.data();
+	GLint sourceLength = static_cast<GLint>(source.size());
+	glShaderSource(shader, 1, &cShaderSource, &sourceLength);
+
+	//Lanzamos la compilacion sin esperar al resultado, el estado se consulta mas tarde
+	glCompileShader(shader);
+
+	return shader;
+}
+
+
+void ReportError(const std::string& message, std::string* errorLog) {
+
+	//Mostramos el error y, si nos lo piden, lo devolvemos al llamador
+	std::cerr << message << std::endl;
+	if (errorLog != nullptr)
+		*errorLog += message + "\n";
+}
+
+
+bool CheckShaderStatus(GLuint shader, GLenum stage, std::string* errorLog) {
+
+	// Verificar errores de compilación
+	GLint success;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+
+	if (!success) {
+
+		//Obtenemos longitud del log
+		GLint logLength;
+		glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &logLength);
+
+		//Obtenemos el log
+		std::vector<GLchar> shaderLog(logLength > 0 ? logLength : 1, '\0');
+		glGetShaderInfoLog(shader, logLength, nullptr, shaderLog.data());
+
+		//Mostramos el log y dejamos que el llamador decida que hacer
+		ReportError(std::string("Se ha producido un error al cargar el ") + ShaderStageName(stage) + " shader:  " + shaderLog.data(), errorLog);
+		return false;
+	}
+
+	return true;
+}
+
+
+GLuint LoadShader(GLenum stage, const std::string& filePath, std::string* errorLog) {
+
+	//Mapeamos el archivo y se lo damos al compilador sin copiarlo; glShaderSource guarda su propia copia
+	FileView source;
+	if (!MapFile(filePath, source)) {
+		ReportError("No se ha podido abrir el archivo: " + filePath, errorLog);
+		return 0;
+	}
+
+	GLuint shader = SubmitShader(stage, ViewOf(source));
+	UnmapFile(source);
+
+	//Si falla la compilacion liberamos el shader y devolvemos 0
+	if (!CheckShaderStatus(shader, stage, errorLog)) {
+		glDeleteShader(shader);
+		return 0;
+	}
+
+	return shader;
+}
+
+
+GLuint SubmitProgram(const ShaderProgram& shaders) {
+
+	//Crear programa de la GPU
+	GLuint program = glCreateProgram();
+
+	//Verificar que existe un vertex shader y adjuntarlo al programa
+	if (shaders.vertexShader != 0) {
+		glAttachShader(program, shaders.vertexShader);
+	}
+	if (shaders.geometryShader != 0) {
+		glAttachShader(program, shaders.geometryShader);
+	}
+	if (shaders.fragmentShader != 0) {
+		glAttachShader(program, shaders.fragmentShader);
+	}
+	if (shaders.computeShader != 0) {
+		glAttachShader(program, shaders.computeShader);
+	}
+
+	//Permitimos recuperar el binario linkado para la cache en disco
+	glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+	// Linkear el programa, sin esperar al resultado
+	glLinkProgram(program);
+
+	return program;
+}
+
+
+bool CheckProgramStatus(GLuint program, const ShaderProgram& shaders, std::string* errorLog) {
+
+	//Obtener estado del programa
+	GLint success;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+
+	//Liberamos recursos: los shaders dejan de hacer falta dentro del programa tanto si ha linkado como si no
+	if (shaders.vertexShader != 0) {
+		glDetachShader(program, shaders.vertexShader);
+	}
+	if (shaders.geometryShader != 0) {
+		glDetachShader(program, shaders.geometryShader);
+	}
+	if (shaders.fragmentShader != 0) {
+		glDetachShader(program, shaders.fragmentShader);
+	}
+	if (shaders.computeShader != 0) {
+		glDetachShader(program, shaders.computeShader);
+	}
+
+	//Mostrar log en caso de error
+	if (!success) {
+
+		//Obtenemos longitud del log
+		GLint logLength;
+		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
+
+		//Almacenamos log
+		std::vector<GLchar> programLog(logLength > 0 ? logLength : 1, '\0');
+		glGetProgramInfoLog(program, logLength, nullptr, programLog.data());
+
+		ReportError(std::string("Error al linkar el programa:  ") + programLog.data(), errorLog);
+		return false;
+	}
+
+	return true;
+}
+
+
+GLuint CreateProgram(const ShaderProgram& shaders, std::string* errorLog) {
+
+	GLuint program = SubmitProgram(shaders);
+
+	//Si falla el linkado liberamos el programa y devolvemos 0
+	if (!CheckProgramStatus(program, shaders, errorLog)) {
+		glDeleteProgram(program);
+		return 0;
+	}
+
+	return program;
+}
+
+
+void DeleteShaders(ShaderProgram& shaders) {
+
+	//glDeleteShader ignora el 0, asi que no hace falta comprobar que etapas existen
+	glDeleteShader(shaders.vertexShader);
+	glDeleteShader(shaders.geometryShader);
+	glDeleteShader(shaders.fragmentShader);
+	glDeleteShader(shaders.computeShader);
+
+	shaders = ShaderProgram();
+}
+
+
+//Hash FNV-1a de 64 bits, suficiente para distinguir codigos fuente
+std::uint64_t HashBytes(const void* data, size_t size, std::uint64_t hash = 14695981039346656037ull) {
+
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+
+	return hash;
+}
+
+
+std::uint64_t HashShaderSource(GLenum stage, std::string_view source) {
+
+	//La etapa forma parte de la clave: el mismo texto no puede servir para dos etapas
+	std::uint64_t hash = HashBytes(&stage, sizeof(stage));
+	return HashBytes(source.data(), source.size(), hash);
+}
+
+
+std::string ProgramBinaryPath(const ShaderRegistry& registry, std::uint64_t programKey) {
+
+	char fileName[32];
+	std::snprintf(fileName, sizeof(fileName), "%016llx.bin", static_cast<unsigned long long>(programKey));
+
+	return registry.cacheDirectory + "/" + fileName;
+}
+
+
+GLuint LoadProgramBinary(const std::string& filePath) {
+
+	std::ifstream file(filePath, std::ios::binary);
+	if (!file.is_open())
+		return 0;
+
+	//Formato del binario seguido del blob devuelto por glGetProgramBinary
+	GLenum format = 0;
+	if (!file.read(reinterpret_cast<char*>(&format), sizeof(format)))
+		return 0;
+
+	std::vector<char> binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	if (file.bad() || binary.empty())
+		return 0;
+
+	GLuint program = glCreateProgram();
+	glProgramBinary(program, format, binary.data(), static_cast<GLsizei>(binary.size()));
+
+	//El driver puede rechazar binarios antiguos, en ese caso se recompila
+	GLint success;
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (!success) {
+		glDeleteProgram(program);
+		return 0;
+	}
+
+	return program;
+}
+
+
+void SaveProgramBinary(GLuint program, const std::string& filePath) {
+
+	GLint binaryLength;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+	if (binaryLength <= 0)
+		return;
+
+	std::vector<char> binary(binaryLength);
+	GLsizei writtenLength = 0;
+	GLenum format = 0;
+	glGetProgramBinary(program, binaryLength, &writtenLength, &format, binary.data());
+
+	//Un binario vacio no se podria volver a cargar: mejor no dejar archivo y recompilar la proxima vez
+	if (writtenLength <= 0)
+		return;
+
+	std::ofstream file(filePath, std::ios::binary);
+	if (!file.is_open()) {
+		std::cerr << "No se ha podido escribir la cache de shaders: " << filePath << std::endl;
+		return;
+	}
+
+	file.write(reinterpret_cast<const char*>(&format), sizeof(format));
+	file.write(binary.data(), writtenLength);
+}
+
+
+GLuint FindOrSubmitShader(ShaderRegistry& registry, GLenum stage, std::uint64_t shaderKey, std::string_view source, bool& submitted) {
+
+	//Si ya existe un shader con el mismo codigo y etapa lo reutilizamos
+	auto found = registry.shaders.find(shaderKey);
+	if (found != registry.shaders.end()) {
+		registry.duplicatesAvoided++;
+		submitted = false;
+		return found->second;
+	}
+
+	GLuint shader = SubmitShader(stage, source);
+	registry.shaders[shaderKey] = shader;
+	registry.shadersCompiled++;
+	submitted = true;
+
+	return shader;
+}
+
+
+ShaderRegistry CreateShaderRegistry(const std::string& cacheDirectory) {
+
+	ShaderRegistry registry;
+	registry.cacheDirectory = cacheDirectory;
+
+	//Los binarios solo son validos para el mismo driver, asi que forma parte de la clave
+	std::string driver;
+	for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+		const GLubyte* value = glGetString(name);
+		if (value != nullptr)
+			driver += reinterpret_cast<const char*>(value);
+	}
+	registry.driverHash = HashBytes(driver.data(), driver.size());
+
+	//Solo usamos la cache en disco si el driver soporta algun formato de binario
+	GLint binaryFormats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormats);
+
+	std::error_code error;
+	std::filesystem::create_directories(cacheDirectory, error);
+	registry.binaryCacheEnabled = binaryFormats > 0 && !error;
+
+	//Si el driver lo permite compila y linka en hilos propios mientras seguimos enviando trabajo
+	if (GLEW_KHR_parallel_shader_compile) {
+		glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+		registry.parallelCompile = true;
+	}
+	else if (GLEW_ARB_parallel_shader_compile) {
+		glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+		registry.parallelCompile = true;
+	}
+
+	return registry;
+}
+
+
+GLuint RequestShader(ShaderRegistry& registry, GLenum stage, const std::string& filePath, std::string* errorLog) {
+
+	FileView source;
+	if (!MapFile(filePath, source)) {
+		ReportError("No se ha podido abrir el archivo: " + filePath, errorLog);
+		return 0;
+	}
+
+	std::uint64_t shaderKey = HashShaderSource(stage, ViewOf(source));
+
+	bool submitted;
+	GLuint shader = FindOrSubmitShader(registry, stage, shaderKey, ViewOf(source), submitted);
+	UnmapFile(source);
+
+	//Un shader que no compila no se queda en el registro
+	if (submitted && !CheckShaderStatus(shader, stage, errorLog)) {
+		registry.shaders.erase(shaderKey);
+		glDeleteShader(shader);
+		return 0;
+	}
+
+	return shader;
+}
+
+
+ProgramBatch SubmitPrograms(ShaderRegistry& registry, const std::vector<ProgramSources>& requests, std::string* errorLog) {
+
+	ProgramBatch batch;
+	std::vector<GLuint>& programs = batch.programs;
+	programs.assign(requests.size(), 0);
+
+	//Resolvemos lo que ya existe y enviamos todas las compilaciones y linkados sin esperar
+	for (size_t i = 0; i < requests.size(); i++) {
+
+		const ProgramSources& sources = requests[i];
+		const std::string* filePaths[] = { &sources.vertexShader, &sources.geometryShader, &sources.fragmentShader, &sources.computeShader };
+		const GLenum stages[] = { GL_VERTEX_SHADER, GL_GEOMETRY_SHADER, GL_FRAGMENT_SHADER, GL_COMPUTE_SHADER };
+
+		//Mapeamos cada etapa una sola vez y combinamos sus claves con la del driver
+		FileView stageSources[4];
+		std::uint64_t stageKeys[4] = {};
+		std::uint64_t programKey = registry.driverHash;
+		bool sourcesFound = true;
+		for (int stage = 0; stage < 4; stage++) {
+			if (filePaths[stage]->empty())
+				continue;
+
+			if (!MapFile(*filePaths[stage], stageSources[stage])) {
+				ReportError("No se ha podido abrir el archivo: " + *filePaths[stage], errorLog);
+				sourcesFound = false;
+				break;
+			}
+
+			stageKeys[stage] = HashShaderSource(stages[stage], ViewOf(stageSources[stage]));
+			programKey = HashBytes(&stageKeys[stage], sizeof(stageKeys[stage]), programKey);
+		}
+
+		//Si falta algun archivo este programa queda a 0, pero seguimos con el resto
+		if (!sourcesFound) {
+			for (FileView& source : stageSources)
+				UnmapFile(source);
+			continue;
+		}
+
+		//Programa ya creado en esta ejecucion (o en esta misma peticion)
+		auto found = registry.programs.find(programKey);
+		if (found != registry.programs.end()) {
+			for (FileView& source : stageSources)
+				UnmapFile(source);
+
+			registry.duplicatesAvoided++;
+			programs[i] = found->second;
+			continue;
+		}
+
+		//Programa linkado en una ejecucion anterior: no hace falta compilar nada
+		std::string binaryPath = ProgramBinaryPath(registry, programKey);
+		if (registry.binaryCacheEnabled) {
+			GLuint program = LoadProgramBinary(binaryPath);
+			if (program != 0) {
+				for (FileView& source : stageSources)
+					UnmapFile(source);
+
+				registry.programs[programKey] = program;
+				registry.programsFromDisk++;
+				programs[i] = program;
+				continue;
+			}
+		}
+
+		//Enviamos la compilacion de las etapas que falten y el linkado del programa
+		GLuint stageShaders[4] = {};
+		for (int stage = 0; stage < 4; stage++) {
+			if (filePaths[stage]->empty())
+				continue;
+
+			bool submitted;
+			stageShaders[stage] = FindOrSubmitShader(registry, stages[stage], stageKeys[stage], ViewOf(stageSources[stage]), submitted);
+			if (submitted)
+				batch.pendingShaders.push_back({ stageShaders[stage], stages[stage], stageKeys[stage] });
+
+			//El driver ya tiene su copia del codigo, podemos liberar el mapeo
+			UnmapFile(stageSources[stage]);
+		}
+
+		ShaderProgram shaders;
+		shaders.vertexShader = stageShaders[0];
+		shaders.geometryShader = stageShaders[1];
+		shaders.fragmentShader = stageShaders[2];
+		shaders.computeShader = stageShaders[3];
+
+		GLuint program = SubmitProgram(shaders);
+		registry.programs[programKey] = program;
+		registry.programStages[program] = shaders;
+		registry.programsLinked++;
+		programs[i] = program;
+
+		batch.pendingPrograms.push_back({ program, programKey, shaders, binaryPath });
+	}
+
+	return batch;
+}
+
+
+//Sin compilacion en paralelo el driver ya ha terminado cuando se consulta cualquier cosa
+bool IsShaderDone(const ShaderRegistry& registry, GLuint shader) {
+
+	GLint done = GL_TRUE;
+	if (registry.parallelCompile)
+		glGetShaderiv(shader, GL_COMPLETION_STATUS_ARB, &done);
+	return done == GL_TRUE;
+}
+
+
+bool IsProgramDone(const ShaderRegistry& registry, GLuint program) {
+
+	GLint done = GL_TRUE;
+	if (registry.parallelCompile)
+		glGetProgramiv(program, GL_COMPLETION_STATUS_ARB, &done);
+	return done == GL_TRUE;
+}
+
+
+bool IsProgramBatchReady(const ShaderRegistry& registry, const ProgramBatch& batch) {
+
+	for (const PendingProgram& pending : batch.pendingPrograms) {
+		if (!IsProgramDone(registry, pending.program))
+			return false;
+	}
+
+	for (const PendingShader& pending : batch.pendingShaders) {
+		if (!IsShaderDone(registry, pending.shader))
+			return false;
+	}
+
+	return true;
+}
+
+
+std::vector<GLuint> FinishPrograms(ShaderRegistry& registry, ProgramBatch& batch, std::string* errorLog) {
+
+	std::vector<GLuint>& programs = batch.programs;
+	std::vector<PendingShader>& pendingShaders = batch.pendingShaders;
+	std::vector<PendingProgram>& pendingPrograms = batch.pendingPrograms;
+
+	//Consultar GL_COMPILE_STATUS o GL_LINK_STATUS bloquea hasta que el driver termina ese objeto. Atendemos
+	//primero lo que ya esta terminado (guardar un binario en disco tambien lleva su tiempo) y solo cedemos el
+	//hilo cuando no hay nada listo. Los shaders que no compilan se sacan del registro para que una version
+	//corregida se vuelva a compilar
+	std::vector<GLuint> failedShaders;
+	std::vector<GLuint> failedPrograms;
+	while (!pendingShaders.empty() || !pendingPrograms.empty()) {
+		bool progress = false;
+
+		for (size_t i = 0; i < pendingShaders.size();) {
+			const PendingShader& pending = pendingShaders[i];
+			if (!IsShaderDone(registry, pending.shader)) {
+				i++;
+				continue;
+			}
+
+			if (!CheckShaderStatus(pending.shader, pending.stage, errorLog)) {
+				registry.shaders.erase(pending.key);
+				failedShaders.push_back(pending.shader);
+			}
+			pendingShaders.erase(pendingShaders.begin() + i);
+			progress = true;
+		}
+
+		for (size_t i = 0; i < pendingPrograms.size();) {
+			const PendingProgram pending = pendingPrograms[i];
+			if (!IsProgramDone(registry, pending.program)) {
+				i++;
+				continue;
+			}
+			pendingPrograms.erase(pendingPrograms.begin() + i);
+			progress = true;
+
+			bool linked = CheckProgramStatus(pending.program, pending.shaders, errorLog);
+
+			if (linked) {
+				if (registry.binaryCacheEnabled)
+					SaveProgramBinary(pending.program, pending.binaryPath);
+				continue;
+			}
+
+			//El programa no sirve: lo quitamos del registro y de todas las peticiones que lo compartian
+			registry.programs.erase(pending.key);
+			registry.programsLinked--;
+			failedPrograms.push_back(pending.program);
+
+			for (GLuint& program : programs) {
+				if (program == pending.program)
+					program = 0;
+			}
+		}
+
+		if (!progress)
+			std::this_thread::yield();
+	}
+
+	//Los shaders fallidos ya no estan enlazados a ningun programa. Los programas fallidos se liberan al final
+	//porque sus etapas podian seguir pendientes dentro del bucle
+	for (GLuint shader : failedShaders)
+		glDeleteShader(shader);
+
+	for (GLuint program : failedPrograms)
+		ReleaseProgram(registry, program);
+
+	return programs;
+}
+
+
+std::vector<GLuint> RequestPrograms(ShaderRegistry& registry, const std::vector<ProgramSources>& requests, std::string* errorLog) {
+
+	ProgramBatch batch = SubmitPrograms(registry, requests, errorLog);
+	return FinishPrograms(registry, batch, errorLog);
+}
+
+
+GLuint RequestProgram(ShaderRegistry& registry, const ProgramSources& sources, std::string* errorLog) {
+
+	return RequestPrograms(registry, { sources }, errorLog).front();
+}
+
+
+void ReleaseProgram(ShaderRegistry& registry, GLuint program) {
+
+	//Quitamos el programa del registro para que nadie mas lo reciba y lo borramos
+	for (auto it = registry.programs.begin(); it != registry.programs.end(); ++it) {
+		if (it->second == program) {
+			registry.programs.erase(it);
+			break;
+		}
+	}
+
+	glDeleteProgram(program);
+
+	auto stages = registry.programStages.find(program);
+	if (stages == registry.programStages.end())
+		return;
+
+	ShaderProgram shaders = stages->second;
+	registry.programStages.erase(stages);
+
+	//Tras una recarga las etapas antiguas solo las usaba este programa: si nadie mas las usa se borran,
+	//y si vuelve a aparecer el mismo codigo se compila otra vez
+	for (GLuint shader : { shaders.vertexShader, shaders.geometryShader, shaders.fragmentShader, shaders.computeShader }) {
+		if (shader == 0)
+			continue;
+
+		bool stillUsed = false;
+		for (const auto& other : registry.programStages) {
+			const ShaderProgram& otherShaders = other.second;
+			if (otherShaders.vertexShader == shader || otherShaders.geometryShader == shader
+				|| otherShaders.fragmentShader == shader || otherShaders.computeShader == shader) {
+				stillUsed = true;
+				break;
+			}
+		}
+		if (stillUsed)
+			continue;
+
+		for (auto it = registry.shaders.begin(); it != registry.shaders.end(); ++it) {
+			if (it->second == shader) {
+				registry.shaders.erase(it);
+				glDeleteShader(shader);
+				break;
+			}
+		}
+	}
+}
+
+
+void DestroyShaderRegistry(ShaderRegistry& registry) {
+
+	for (auto& program : registry.programs)
+		glDeleteProgram(program.second);
+
+	for (auto& shader : registry.shaders)
+		glDeleteShader(shader.second);
+
+	registry.programs.clear();
+	registry.shaders.clear();
+	registry.programStages.clear();
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct ShaderProgram
+{
+	GLuint vertexShader = 0;
+	GLuint geometryShader = 0;
+	GLuint fragmentShader = 0;
+	GLuint computeShader = 0;
+};
+
+//Rutas de los ficheros de cada etapa de un programa (vacia si la etapa no se usa). Un programa de compute
+//solo lleva computeShader
+struct ProgramSources
+{
+	std::string vertexShader;
+	std::string geometryShader;
+	std::string fragmentShader;
+	std::string computeShader;
+};
+
+//Registro de shaders y programas indexado por hash del codigo fuente y etapa.
+//Devuelve el mismo objeto de GL ante peticiones repetidas y guarda los binarios linkados en disco
+struct ShaderRegistry
+{
+	std::unordered_map<std::uint64_t, GLuint> shaders;
+	std::unordered_map<std::uint64_t, GLuint> programs;
+
+	//Etapas con las que se ha linkado cada programa, para saber que shaders siguen en uso al liberar uno.
+	//Los programas cargados desde disco no tienen etapas
+	std::unordered_map<GLuint, ShaderProgram> programStages;
+
+	std::string cacheDirectory;
+	std::uint64_t driverHash = 0;
+	bool binaryCacheEnabled = false;
+	bool parallelCompile = false;
+
+	//Estadisticas para el informe de arranque
+	int shadersCompiled = 0;
+	int programsLinked = 0;
+	int programsFromDisk = 0;
+	int duplicatesAvoided = 0;
+};
+
+//Compilaciones y linkados enviados al driver cuyo estado aun no se ha consultado
+struct PendingShader
+{
+	GLuint shader = 0;
+	GLenum stage = 0;
+	std::uint64_t key = 0;
+};
+
+struct PendingProgram
+{
+	GLuint program = 0;
+	std::uint64_t key = 0;
+	ShaderProgram shaders;
+	std::string binaryPath;
+};
+
+//Lote de programas pedidos con SubmitPrograms. programs tiene un programa por peticion (0 si ya ha fallado)
+struct ProgramBatch
+{
+	std::vector<GLuint> programs;
+	std::vector<PendingShader> pendingShaders;
+	std::vector<PendingProgram> pendingPrograms;
+};
+
+//Todas las funciones que pueden fallar devuelven 0 (o false) en lugar de cerrar la aplicacion,
+//liberan los objetos de GL que hayan creado y, si errorLog no es nulo, le añaden el mensaje de error
+
+GLuint SubmitShader(GLenum stage, std::string_view source);
+
+bool CheckShaderStatus(GLuint shader, GLenum stage, std::string* errorLog = nullptr);
+
+GLuint LoadShader(GLenum stage, const std::string& filePath, std::string* errorLog = nullptr);
+
+GLuint SubmitProgram(const ShaderProgram& shaders);
+
+bool CheckProgramStatus(GLuint program, const ShaderProgram& shaders, std::string* errorLog = nullptr);
+
+GLuint CreateProgram(const ShaderProgram& shaders, std::string* errorLog = nullptr);
+
+void DeleteShaders(ShaderProgram& shaders);
+
+ShaderRegistry CreateShaderRegistry(const std::string& cacheDirectory);
+
+GLuint RequestShader(ShaderRegistry& registry, GLenum stage, const std::string& filePath, std::string* errorLog = nullptr);
+
+//Envia todas las compilaciones y linkados del lote sin esperar a ninguno. Con compilacion en paralelo el
+//driver los termina en sus hilos mientras el llamador hace otro trabajo
+ProgramBatch SubmitPrograms(ShaderRegistry& registry, const std::vector<ProgramSources>& requests, std::string* errorLog = nullptr);
+
+//Pregunta sin bloquear si el driver ya ha terminado todos los shaders y programas del lote
+bool IsProgramBatchReady(const ShaderRegistry& registry, const ProgramBatch& batch);
+
+//Comprueba el estado de cada shader y programa segun los va terminando el driver y guarda los binarios.
+//Devuelve los programas del lote, con 0 en los que han fallado
+std::vector<GLuint> FinishPrograms(ShaderRegistry& registry, ProgramBatch& batch, std::string* errorLog = nullptr);
+
+//SubmitPrograms seguido de FinishPrograms
+std::vector<GLuint> RequestPrograms(ShaderRegistry& registry, const std::vector<ProgramSources>& requests, std::string* errorLog = nullptr);
+
+GLuint RequestProgram(ShaderRegistry& registry, const ProgramSources& sources, std::string* errorLog = nullptr);
+
+//Borra el programa y los shaders de sus etapas que ya no usa ningun otro programa del registro
+void ReleaseProgram(ShaderRegistry& registry, GLuint program);
+
+void DestroyShaderRegistry(ShaderRegistry& registry);
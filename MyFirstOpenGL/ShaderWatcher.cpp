@@ -0,0 +1,185 @@
+#include "ShaderWatcher.h"
+#include <iostream>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+//Cada cuanto se consultan las fechas de modificacion cuando no hay inotify
+#define SHADER_POLL_INTERVAL_MS 500
+
+
+std::string NormalizedPath(const std::filesystem::path& filePath) {
+
+	return filePath.lexically_normal().generic_string();
+}
+
+
+ShaderWatcher CreateShaderWatcher() {
+
+	ShaderWatcher watcher;
+
+#ifdef __linux__
+	//Descriptor no bloqueante: en cada frame solo leemos los eventos que ya hayan llegado
+	watcher.inotifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (watcher.inotifyDescriptor < 0)
+		std::cerr << "No se ha podido iniciar inotify, la recarga de shaders queda desactivada" << std::endl;
+#else
+	watcher.lastPoll = std::chrono::steady_clock::now();
+#endif
+
+	return watcher;
+}
+
+
+void WatchFile(ShaderWatcher& watcher, const std::string& filePath) {
+
+#ifdef __linux__
+	if (watcher.inotifyDescriptor < 0)
+		return;
+
+	//Vigilamos la carpeta y no el archivo: muchos editores guardan escribiendo otro archivo y renombrandolo
+	std::filesystem::path directory = std::filesystem::path(filePath).parent_path();
+	if (directory.empty())
+		directory = ".";
+
+	int watchDescriptor = inotify_add_watch(watcher.inotifyDescriptor, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+	if (watchDescriptor >= 0)
+		watcher.watchedDirectories[watchDescriptor] = directory;
+#else
+	std::error_code error;
+	watcher.lastWriteTimes[NormalizedPath(filePath)] = std::filesystem::last_write_time(filePath, error);
+#endif
+}
+
+
+void WatchProgram(ShaderWatcher& watcher, const ProgramSources& sources, GLuint* program) {
+
+	watcher.programs.push_back({ sources, program });
+
+	for (const std::string* filePath : { &sources.vertexShader, &sources.geometryShader, &sources.fragmentShader, &sources.computeShader }) {
+		if (!filePath->empty())
+			WatchFile(watcher, *filePath);
+	}
+}
+
+
+void CollectChangedFiles(ShaderWatcher& watcher) {
+
+#ifdef __linux__
+	if (watcher.inotifyDescriptor < 0)
+		return;
+
+	alignas(inotify_event) char buffer[4096];
+	ssize_t length;
+
+	//Vaciamos la cola de eventos sin bloquear
+	while ((length = read(watcher.inotifyDescriptor, buffer, sizeof(buffer))) > 0) {
+		for (char* pointer = buffer; pointer < buffer + length; ) {
+			const inotify_event* event = reinterpret_cast<const inotify_event*>(pointer);
+			pointer += sizeof(inotify_event) + event->len;
+
+			auto directory = watcher.watchedDirectories.find(event->wd);
+			if (event->len > 0 && directory != watcher.watchedDirectories.end())
+				watcher.changedFiles.insert(NormalizedPath(directory->second / event->name));
+		}
+	}
+#else
+	//Sin inotify consultamos las fechas de modificacion, pero no en todos los frames
+	auto now = std::chrono::steady_clock::now();
+	if (now - watcher.lastPoll < std::chrono::milliseconds(SHADER_POLL_INTERVAL_MS))
+		return;
+	watcher.lastPoll = now;
+
+	for (auto& file : watcher.lastWriteTimes) {
+		std::error_code error;
+		std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(file.first, error);
+		if (!error && writeTime != file.second) {
+			file.second = writeTime;
+			watcher.changedFiles.insert(file.first);
+		}
+	}
+#endif
+}
+
+
+bool ApplyShaderReloads(ShaderWatcher& watcher, ShaderRegistry& registry) {
+
+	CollectChangedFiles(watcher);
+	if (watcher.changedFiles.empty())
+		return false;
+
+	//Solo se reconstruyen los programas que usan alguno de los archivos modificados
+	std::vector<WatchedProgram*> affectedPrograms;
+	std::vector<ProgramSources> requests;
+	for (WatchedProgram& watched : watcher.programs) {
+		for (const std::string* filePath : { &watched.sources.vertexShader, &watched.sources.geometryShader, &watched.sources.fragmentShader, &watched.sources.computeShader }) {
+			if (!filePath->empty() && watcher.changedFiles.count(NormalizedPath(*filePath)) > 0) {
+				affectedPrograms.push_back(&watched);
+				requests.push_back(watched.sources);
+				break;
+			}
+		}
+	}
+	watcher.changedFiles.clear();
+
+	if (affectedPrograms.empty())
+		return false;
+
+	//El registro reutiliza las etapas que no han cambiado, asi que solo se compila la modificada
+	auto reloadStart = std::chrono::steady_clock::now();
+	std::vector<GLuint> rebuiltPrograms = RequestPrograms(registry, requests);
+	double reloadMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - reloadStart).count();
+
+	//Cambiamos todos los programas a la vez, antes de dibujar nada en este frame
+	bool swapped = false;
+	for (size_t i = 0; i < affectedPrograms.size(); i++) {
+
+		GLuint oldProgram = *affectedPrograms[i]->program;
+		GLuint newProgram = rebuiltPrograms[i];
+
+		//Si el nuevo programa falla seguimos dibujando con el anterior
+		if (newProgram == 0) {
+			std::cerr << "Recarga fallida, se mantiene el programa anterior" << std::endl;
+			continue;
+		}
+
+		//El archivo se ha guardado sin cambios reales
+		if (newProgram == oldProgram)
+			continue;
+
+		*affectedPrograms[i]->program = newProgram;
+		swapped = true;
+
+		//Liberamos el programa anterior si ningun otro programa vigilado lo sigue usando
+		bool stillUsed = false;
+		for (const WatchedProgram& watched : watcher.programs) {
+			if (*watched.program == oldProgram)
+				stillUsed = true;
+		}
+		if (!stillUsed)
+			ReleaseProgram(registry, oldProgram);
+	}
+
+	if (swapped)
+		std::cout << "Shaders recargados en " << reloadMilliseconds << " ms" << std::endl;
+
+	return swapped;
+}
+
+
+void DestroyShaderWatcher(ShaderWatcher& watcher) {
+
+#ifdef __linux__
+	if (watcher.inotifyDescriptor >= 0)
+		close(watcher.inotifyDescriptor);
+	watcher.inotifyDescriptor = -1;
+	watcher.watchedDirectories.clear();
+#else
+	watcher.lastWriteTimes.clear();
+#endif
+
+	watcher.programs.clear();
+	watcher.changedFiles.clear();
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Shader.h"
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+//Programa vigilado: sus fuentes y la variable que usa el game loop para dibujar con el
+struct WatchedProgram
+{
+	ProgramSources sources;
+	GLuint* program = nullptr;
+};
+
+//Vigila los archivos de los shaders y reconstruye solo los programas afectados por un cambio.
+//En Linux usa inotify sobre las carpetas; en el resto de plataformas consulta la fecha de modificacion
+struct ShaderWatcher
+{
+	std::vector<WatchedProgram> programs;
+	std::unordered_set<std::string> changedFiles;
+
+#ifdef __linux__
+	int inotifyDescriptor = -1;
+	std::unordered_map<int, std::filesystem::path> watchedDirectories;
+#else
+	std::unordered_map<std::string, std::filesystem::file_time_type> lastWriteTimes;
+	std::chrono::steady_clock::time_point lastPoll;
+#endif
+};
+
+ShaderWatcher CreateShaderWatcher();
+
+void WatchProgram(ShaderWatcher& watcher, const ProgramSources& sources, GLuint* program);
+
+bool ApplyShaderReloads(ShaderWatcher& watcher, ShaderRegistry& registry);
+
+void DestroyShaderWatcher(ShaderWatcher& watcher);
@@ -1,440 +1,411 @@
-#include <GL/glew.h>
-#include <GLFW/glfw3.h>
+#include "Platform.h"
+#include "Shader.h"
+#include "ShaderWatcher.h"
+#include "Benchmark.h"
+#include "Profiler.h"
+#include "GameObjects.h"
+#include "JobSystem.h"
+#include "ModelMatrix.h"
+#include "MeshFile.h"
+#include "ModelImporter.h"
+#include "StreamBuffer.h"
+#include "Camera.h"
+#include "Culling.h"
+#include "Bvh.h"
+#include "IndirectDraw.h"
+#include "GpuCulling.h"
+#include "RenderQueue.h"
+#include "StateCache.h"
+#include "SceneMeshes.h"
 #include <glm.hpp>
 #include <gtc/type_ptr.hpp>
 #include <gtc/matrix_transform.hpp>
 #include <iostream>
 #include <string>
-#include <fstream>
 #include <vector>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
 
 #define WINDOW_WIDTH_DEFAULT 640
 #define WINDOW_HEIGHT_DEFAULT 480
 
-int windowWidth = WINDOW_WIDTH_DEFAULT;
-int windowHeight = WINDOW_HEIGHT_DEFAULT;
+//Carpeta donde se guardan los programas linkados entre ejecuciones
+#define SHADER_CACHE_DIRECTORY "ShaderCache"
 
-struct ShaderProgram
-{
-	GLuint vertexShader = 0;
-	GLuint geometryShader = 0;
-	GLuint fragmentShader = 0;
-};
+//Punto de binding del bloque CameraTransform en los shaders
+#define CAMERA_BLOCK_BINDING 1
 
+//Puntos de binding de los SSBO ObjectTransforms (matrices de modelo) y DrawParameters (primera matriz de cada draw)
+#define OBJECT_TRANSFORMS_BINDING 0
+#define DRAW_PARAMETERS_BINDING 1
 
-struct Transform
-{
-	glm::vec3 position = glm::vec3(0.f);
-	glm::vec3 forward = glm::vec3(1.f, 0.f, 0.f);
-	glm::vec3 rotation = glm::vec3(0.f);
-	float velocity = 0.0005f;
-	float angularVelocity = -.05f;
-};
+//Slot de cada matriz dentro del buffer de transformaciones (las de los objetos van en el SSBO)
+#define CAMERA_SLOT 0
+#define TRANSFORM_SLOT_COUNT 1
 
-struct GameObject {
+//Posicion de cada malla en la arena
+#define ARENA_HEXAEDRO 0
+#define ARENA_PENTAEDRO 1
 
-	glm::vec3 position = glm::vec3(0.f);
-	glm::vec3 rotation = glm::vec3(0.f);
-	glm::vec3 scale = glm::vec3(1.f);
+//Lotes de draws indirectos por frame, uno por programa
+#define DRAW_BATCH_COUNT 2
 
-	glm::vec3 forward = glm::vec3(0.f);
-	glm::vec3 forwardRotation = glm::vec3(0.f);
-	float velocity = 0.0005f;
-	float angularVelocity = -.05f;
-};
+//Capas de la cola de render. Sin depth test el orden entre capas es el de pintado: la piramide va encima
+#define LAYER_HEXAEDROS 0
+#define LAYER_PIRAMIDE 1
 
+//Duracion del paso fijo de simulacion en segundos. Las velocidades de los GameObject son por paso
+#define SIMULATION_STEP (1.0 / 60.0)
 
+//Pasos maximos por frame: si un frame tarda demasiado se ralentiza la simulacion en vez de acumular retraso
+#define MAX_SIMULATION_STEPS 8
 
-void Resize_Window(GLFWwindow* window, int iFrameBufferWidth, int iFrameBufferHeight) {
+//Objetos minimos por trabajo al repartir la simulacion entre hilos (las matrices se reparten por CULL_JOB_GRAIN)
+#define SIMULATION_JOB_GRAIN 16384
 
-	//Definir nuevo tamao del viewport
-	glViewport(0, 0, iFrameBufferWidth, iFrameBufferHeight);
+//Posicion de cada objeto en el BVH de la escena; los hexaedros extra van a partir de SCENE_CROWD
+#define SCENE_CUBO 0
+#define SCENE_ORTOEDRO 1
+#define SCENE_PIRAMIDE 2
+#define SCENE_CROWD 3
 
-	windowWidth = iFrameBufferWidth;
-	windowHeight = iFrameBufferHeight;
-}
+//Se reconstruye el BVH cuando los refits empeoran su coste SAH este factor respecto al recien construido
+#define BVH_REBUILD_RATIO 1.5f
 
+//Frames que dibuja la version headless si no se indica --frames
+#define HEADLESS_FRAMES_DEFAULT 120
 
-glm::mat4 GenerateTranslationMatrix(glm::vec3 translation)
+struct Transform
 {
-	return glm::translate(glm::mat4(1.f), translation);
-}
-
+	glm::vec3 position = glm::vec3(0.f);
+	glm::vec3 forward = glm::vec3(1.f, 0.f, 0.f);
+	glm::vec3 rotation = glm::vec3(0.f);
+	float velocity = 0.0005f;
+	float angularVelocity = -.05f;
+};
 
-glm::mat4 GenerateRotationMatrix(glm::vec3 axis, float degrees)
+//Localizaciones de los uniforms de un programa, resueltas una sola vez tras linkarlo
+struct UniformLocations
 {
-	return glm::rotate(glm::mat4(1.f), glm::radians(degrees), glm::normalize(axis));
-}
+	GLint windowSize = -1;
+	GLint time = -1;
+};
 
+//Numero de llamadas a glGetUniformLocation realizadas durante el frame actual
+int uniformLookupsThisFrame = 0;
 
-glm::mat4 GenerateScaleMatrix(glm::vec3 scale)
+//UBO std140 con una matriz por slot. Cada frame reserva sus slots en un StreamBuffer
+//para no escribir lo que la GPU aun esta leyendo
+struct TransformBuffer
 {
-	return glm::scale(glm::mat4(1.f), scale);
-}
-
-
-std::string Load_File(const std::string& filePath) {
-
-	std::ifstream file(filePath);
+	StreamBuffer stream;
+	StreamAllocation frame;
+	GLsizeiptr slotStride = 0;
+	int maxObjects = 0;
+};
 
-	std::string fileContent;
-	std::string line;
 
-	//Lanzamos error si el archivo no se ha podido abrir
-	if (!file.is_open()) {
-		std::cerr << "No se ha podido abrir el archivo: " << filePath << std::endl;
-		std::exit(EXIT_FAILURE);
-	}
-
-	//Leemos el contenido y lo volcamos a la variable auxiliar
-	while (std::getline(file, line)) {
-		fileContent += line + "\n";
-	}
 
-	//Cerramos stream de datos y devolvemos contenido
-	file.close();
-
-	return fileContent;
+float RandomRange(float min, float max)
+{
+	return min + (max - min) * (static_cast<float>(rand()) / RAND_MAX);
 }
 
 
-GLuint LoadVertexShader(const std::string& filePath) {
+GLint GetUniformLocation(GLuint program, const char* name) {
 
-	// Crear un vertex shader
-	GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+	//Contamos la consulta para poder comprobar que no se hacen en el game loop
+	uniformLookupsThisFrame++;
 
-	//Usamos la funcion creada para leer el vertex shader y almacenarlo
-	std::string sShaderCode = Load_File(filePath);
-	const char* cShaderSource = sShaderCode.c_str();
+	return glGetUniformLocation(program, name);
+}
 
-	//Vinculamos el vertex shader con su cdigo fuente
-	glShaderSource(vertexShader, 1, &cShaderSource, nullptr);
 
-	// Compilar el vertex shader
-	glCompileShader(vertexShader);
+UniformLocations CacheUniformLocations(GLuint program) {
 
-	// Verificar errores de compilacin
-	GLint success;
-	glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
+	//Resolvemos todas las localizaciones una unica vez, justo despues de linkar
+	UniformLocations uniforms;
+	uniforms.windowSize = GetUniformLocation(program, "windowSize");
+	uniforms.time = GetUniformLocation(program, "time");
 
-	//Si la compilacion ha sido exitosa devolvemos el vertex shader
-	if (success) {
+	return uniforms;
+}
 
-		return vertexShader;
 
-	}
-	else {
+TransformBuffer CreateTransformBuffer(int maxObjects) {
 
-		//Obtenemos longitud del log
-		GLint logLength;
-		glGetShaderiv(vertexShader, GL_INFO_LOG_LENGTH, &logLength);
+	TransformBuffer transforms;
+	transforms.maxObjects = maxObjects;
 
-		//Obtenemos el log
-		std::vector<GLchar> errorLog(logLength);
-		glGetShaderInfoLog(vertexShader, logLength, nullptr, errorLog.data());
+	//Cada slot debe empezar en un offset alineado para poder usar glBindBufferRange
+	GLint alignment;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	transforms.slotStride = ((sizeof(glm::mat4) + alignment - 1) / alignment) * alignment;
+	transforms.stream = CreateStreamBuffer(GL_UNIFORM_BUFFER, transforms.slotStride * maxObjects, alignment);
 
-		//Mostramos el log y finalizamos programa
-		std::cerr << "Se ha producido un error al cargar el vertex shader:  " << errorLog.data() << std::endl;
-		std::exit(EXIT_FAILURE);
-	}
+	return transforms;
 }
 
 
-GLuint LoadGeometryShader(const std::string& filePath) {
+void BeginTransformFrame(TransformBuffer& transforms) {
 
-	// Crear un vertex shader
-	GLuint geometryShader = glCreateShader(GL_GEOMETRY_SHADER);
-
-	//Usamos la funcion creada para leer el vertex shader y almacenarlo
-	std::string sShaderCode = Load_File(filePath);
-	const char* cShaderSource = sShaderCode.c_str();
+	BeginStreamFrame(transforms.stream);
+	transforms.frame = AllocateStream(transforms.stream, transforms.slotStride * transforms.maxObjects);
+}
 
-	//Vinculamos el vertex shader con su cdigo fuente
-	glShaderSource(geometryShader, 1, &cShaderSource, nullptr);
 
-	// Compilar el vertex shader
-	glCompileShader(geometryShader);
+void WriteModelMatrix(TransformBuffer& transforms, int slot, const glm::mat4& modelMatrix) {
 
-	// Verificar errores de compilacin
-	GLint success;
-	glGetShaderiv(geometryShader, GL_COMPILE_STATUS, &success);
+	//Escribimos directamente en la memoria mapeada, sin llamadas a GL
+	std::memcpy(transforms.frame.data + transforms.slotStride * slot, glm::value_ptr(modelMatrix), sizeof(glm::mat4));
+}
 
-	//Si la compilacion ha sido exitosa devolvemos el vertex shader
-	if (success) {
 
-		return geometryShader;
+void BindModelMatrix(GLStateCache& cache, const TransformBuffer& transforms, int slot, GLuint binding) {
 
-	}
-	else {
+	BufferRange range;
+	range.buffer = transforms.stream.buffer;
+	range.offset = transforms.frame.offset + transforms.slotStride * slot;
+	range.size = sizeof(glm::mat4);
+	CachedBindBufferRange(cache, GL_UNIFORM_BUFFER, binding, range);
+}
 
-		//Obtenemos longitud del log
-		GLint logLength;
-		glGetShaderiv(geometryShader, GL_INFO_LOG_LENGTH, &logLength);
 
-		//Obtenemos el log
-		std::vector<GLchar> errorLog(logLength);
-		glGetShaderInfoLog(geometryShader, logLength, nullptr, errorLog.data());
+void EndTransformFrame(TransformBuffer& transforms) {
 
-		//Mostramos el log y finalizamos programa
-		std::cerr << "Se ha producido un error al cargar el geometry shader:  " << errorLog.data() << std::endl;
-		std::exit(EXIT_FAILURE);
-	}
+	EndStreamFrame(transforms.stream);
 }
 
 
-GLuint LoadFragmentShader(const std::string& filePath) {
+void DestroyTransformBuffer(TransformBuffer& transforms) {
 
-	// Crear un vertex shader
-	GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-
-	//Usamos la funcion creada para leer el vertex shader y almacenarlo
-	std::string sShaderCode = Load_File(filePath);
-	const char* cShaderSource = sShaderCode.c_str();
-
-	//Vinculamos el vertex shader con su cdigo fuente
-	glShaderSource(fragmentShader, 1, &cShaderSource, nullptr);
+	DestroyStreamBuffer(transforms.stream);
+}
 
-	// Compilar el vertex shader
-	glCompileShader(fragmentShader);
 
-	// Verificar errores de compilacin
-	GLint success;
-	glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
 
-	//Si la compilacion ha sido exitosa devolvemos el vertex shader
-	if (success) {
 
-		return fragmentShader;
+int main(int argc, char* argv[]) {
 
+	//Numero de hexaedros extra a instanciar (--crowd N)
+	int crowdSize = 0;
+	for (int i = 1; i < argc - 1; i++) {
+		if (std::strcmp(argv[i], "--crowd") == 0)
+			crowdSize = std::max(0, std::atoi(argv[i + 1]));
 	}
-	else {
-
-		//Obtenemos longitud del log
-		GLint logLength;
-		glGetShaderiv(fragmentShader, GL_INFO_LOG_LENGTH, &logLength);
 
-		//Obtenemos el log
-		std::vector<GLchar> errorLog(logLength);
-		glGetShaderInfoLog(fragmentShader, logLength, nullptr, errorLog.data());
-
-		//Mostramos el log y finalizamos programa
-		std::cerr << "Se ha producido un error al cargar el fragment shader:  " << errorLog.data() << std::endl;
-		std::exit(EXIT_FAILURE);
+	//Hilos de trabajo ademas del principal (--threads N), por defecto uno por nucleo
+	size_t workerCount = DefaultWorkerCount();
+	for (int i = 1; i < argc - 1; i++) {
+		if (std::strcmp(argv[i], "--threads") == 0)
+			workerCount = static_cast<size_t>(std::max(0, std::atoi(argv[i + 1])));
 	}
-}
-
-
-GLuint CreateProgram(const ShaderProgram& shaders) {
-
-	//Crear programa de la GPU
-	GLuint program = glCreateProgram();
 
-	//Verificar que existe un vertex shader y adjuntarlo al programa
-	if (shaders.vertexShader != 0) {
-		glAttachShader(program, shaders.vertexShader);
-	}
-	if (shaders.geometryShader != 0) {
-		glAttachShader(program, shaders.geometryShader);
-	}
-	if (shaders.fragmentShader != 0) {
-		glAttachShader(program, shaders.fragmentShader);
+	//Ventana (o contexto offscreen en la version headless)
+	PlatformSettings platformSettings;
+	platformSettings.width = WINDOW_WIDTH_DEFAULT;
+	platformSettings.height = WINDOW_HEIGHT_DEFAULT;
+	platformSettings.title = "My Engine";
+	platformSettings.maxFrames = HEADLESS_FRAMES_DEFAULT;
+
+	//Solo headless: frames a dibujar (--frames N) y archivo donde guardar el ultimo (--output frame.ppm)
+	for (int i = 1; i < argc - 1; i++) {
+		if (std::strcmp(argv[i], "--frames") == 0)
+			platformSettings.maxFrames = std::atoi(argv[i + 1]);
+		if (std::strcmp(argv[i], "--output") == 0)
+			platformSettings.frameOutput = argv[i + 1];
 	}
 
-	// Linkear el programa
-	glLinkProgram(program);
+	//Camara ortografica que ve el cubo [-1, 1] ampliado zoom veces (--zoom N). Con zoom > 1 parte de la escena
+	//queda fuera de pantalla y el culling deja de enviarla
+	float cameraZoom = 1.f;
+	for (int i = 1; i < argc - 1; i++) {
+		if (std::strcmp(argv[i], "--zoom") == 0)
+			cameraZoom = std::max(0.01f, static_cast<float>(std::atof(argv[i + 1])));
+	}
 
-	//Obtener estado del programa
-	GLint success;
-	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	//Culling de los hexaedros en un compute shader que escribe el draw indirecto (--gpu-culling). Al cerrar se
+	//comprueba el ultimo frame contra la CPU y, si no coinciden, se sale con error
+	bool gpuCullingEnabled = false;
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--gpu-culling") == 0)
+			gpuCullingEnabled = true;
+	}
 
-	//Devolver programa si todo es correcto o mostrar log en caso de error
-	if (success) {
+	//Profiler de CPU y GPU; al cerrar muestra percentiles y guarda la traza (--profile traza.json)
+	std::string profileOutput;
+	for (int i = 1; i < argc - 1; i++) {
+		if (std::strcmp(argv[i], "--profile") == 0)
+			profileOutput = argv[i + 1];
+	}
 
-		//Liberamos recursos
-		if (shaders.vertexShader != 0) {
-			glDetachShader(program, shaders.vertexShader);
+	//Micro-benchmarks de CPU (--benchmark), no necesitan ventana
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--benchmark") == 0) {
+			return RunBenchmarks() ? 0 : EXIT_FAILURE;
 		}
-		if (shaders.geometryShader != 0) {
-			glDetachShader(program, shaders.geometryShader);
-		}
-		if (shaders.fragmentShader != 0) {
-			glDetachShader(program, shaders.fragmentShader);
-		}
-
-		return program;
 	}
-	else {
-
-		//Obtenemos longitud del log
-		GLint logLength;
-		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &logLength);
 
-		//Almacenamos log
-		std::vector<GLchar> errorLog(logLength);
-		glGetProgramInfoLog(program, logLength, nullptr, errorLog.data());
-
-		std::cerr << "Error al linkar el programa:  " << errorLog.data() << std::endl;
-		std::exit(EXIT_FAILURE);
+	//Vuelve a escribir Hexaedro.mesh y Pentaedro.mesh desde SceneMeshes.cpp (--bake-meshes directorio)
+	for (int i = 1; i < argc - 1; i++) {
+		if (std::strcmp(argv[i], "--bake-meshes") == 0)
+			return BakeSceneMeshes(argv[i + 1]) ? 0 : EXIT_FAILURE;
 	}
-}
-
-
-
 
-void main() {
+	//Convierte un modelo .obj o .glb a .mesh (--convert modelo.obj Modelo.mesh) sin abrir ventana
+	for (int i = 1; i < argc - 2; i++) {
+		if (std::strcmp(argv[i], "--convert") == 0)
+			return ConvertModel(argv[i + 1], argv[i + 2], workerCount) ? 0 : EXIT_FAILURE;
+	}
 
-	//Definir semillas del rand segn el tiempo
+	//Definir semillas del rand según el tiempo
 	srand(static_cast<unsigned int>(time(NULL)));
 
-	//Inicializamos GLFW para gestionar ventanas e inputs
-	glfwInit();
-
-	//Configuramos la ventana
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 4);
-	glfwWindowHint(GLFW_RESIZABLE, GL_TRUE);
-
-	//Inicializamos la ventana
-	GLFWwindow* window = glfwCreateWindow(windowWidth, windowHeight, "My Engine", NULL, NULL);
-
-	//Asignamos funcin de callback para cuando el frame buffer es modificado
-	glfwSetFramebufferSizeCallback(window, Resize_Window);
+	//Creamos la ventana, el contexto e inicializamos GLEW
+	Platform platform;
+	bool gpuCullingValid = true;
+	if (CreatePlatform(platform, platformSettings)) {
 
-	//Definimos espacio de trabajo
-	glfwMakeContextCurrent(window);
+		//Activamos cull face
+		glEnable(GL_CULL_FACE);
 
-	//Permitimos a GLEW usar funcionalidades experimentales
-	glewExperimental = GL_TRUE;
-
-	//Activamos cull face
-	glEnable(GL_CULL_FACE);
-
-	//Indicamos lado del culling
-	glCullFace(GL_BACK);
-
-	//Inicializamos GLEW y controlamos errores
-	if (glewInit() == GLEW_OK) {
+		//Indicamos lado del culling
+		glCullFace(GL_BACK);
 
 		//Declarar GameObjects
 		GameObject cubo, piramide, ortoedro;
 
-		//Declarar vec2 para definir el offset
-		glm::vec2 offset = glm::vec2(0.f, 0.f);
+		//Hexaedros extra que se dibujan en la misma llamada que el cubo y el ortoedro
+		std::vector<GameObject> crowd(crowdSize);
+		for (GameObject& hexaedro : crowd) {
+			hexaedro.position = glm::vec3(RandomRange(-1.f, 1.f), RandomRange(-0.9f, 0.9f), 0.f);
+			hexaedro.scale = glm::vec3(RandomRange(0.05f, 0.15f));
+			hexaedro.forward = glm::vec3(0.f, RandomRange(0.5f, 1.5f), 0.f);
+			hexaedro.forwardRotation = glm::vec3(0.f, 1.f, 0.f);
+		}
 
-		//Compilar shaders
-		ShaderProgram cuboProgram, piramideProgram, ortoedroProgram;
-		cuboProgram.vertexShader = LoadVertexShader("NormalVertexShader.glsl");
-		cuboProgram.fragmentShader = LoadFragmentShader("UpYellowDownOrange.glsl");
+		//Medimos el tiempo de preparacion de los shaders para comparar arranque en frio y en caliente
+		auto shadersStart = std::chrono::steady_clock::now();
 
-		ortoedroProgram.vertexShader = LoadVertexShader("NormalVertexShader.glsl");
-		ortoedroProgram.fragmentShader = LoadFragmentShader("UpYellowDownOrange.glsl");
+		//Registro de shaders con cache de binarios en disco
+		ShaderRegistry shaderRegistry = CreateShaderRegistry(SHADER_CACHE_DIRECTORY);
 
-		piramideProgram.vertexShader = LoadVertexShader("NormalVertexShader.glsl");
-		piramideProgram.fragmentShader = LoadFragmentShader("RGBConstantChange.glsl");
+		//Compilar shaders
+		ProgramSources hexaedroProgram, piramideProgram;
+		hexaedroProgram.vertexShader = "InstancedVertexShader.glsl";
+		hexaedroProgram.fragmentShader = "UpYellowDownOrange.glsl";
+
+		piramideProgram.vertexShader = "InstancedVertexShader.glsl";
+		piramideProgram.fragmentShader = "RGBConstantChange.glsl";
 
-		//Compilar programa
-		GLuint cuboCompiledProgram, piramideCompiledProgram, ortoedroCompiledProgram;
-		cuboCompiledProgram = CreateProgram(cuboProgram);
-		piramideCompiledProgram = CreateProgram(piramideProgram);
-		ortoedroCompiledProgram = CreateProgram(ortoedroProgram);
+		ProgramSources cullingProgram;
+		cullingProgram.computeShader = "CullingComputeShader.glsl";
 
-		//Obtener referencia a offset
-		GLint offsetReference = glGetUniformLocation(cuboCompiledProgram, "offset");
+		//Enviamos todos los programas en un solo lote (o los recuperamos del registro o de la cache en disco)
+		std::vector<ProgramSources> programRequests = { hexaedroProgram, piramideProgram };
+		if (gpuCullingEnabled)
+			programRequests.push_back(cullingProgram);
+		ProgramBatch programBatch = SubmitPrograms(shaderRegistry, programRequests);
+		double shadersMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - shadersStart).count();
 
 		//Definimos color para limpiar el buffer de color
 		glClearColor(0.f, 0.f, 0.f, 1.f);
 
-		GLuint vaoCubo, vaoPiramide;
-		GLuint vboHexaedro, vboPentaedro;
-		//Definimos cantidad de vao a crear y donde almacenarlos
-		glGenVertexArrays(1, &vaoCubo);
-
-		//Indico que el VAO activo de la GPU es el que acabo de crear
-		glBindVertexArray(vaoCubo);
-
-		//Definimos cantidad de vbo a crear y donde almacenarlos
-		glGenBuffers(1, &vboHexaedro);
-
-		//Indico que el VBO activo es el que acabo de crear y que almacenar un array. Todos los VBO que genere se asignaran al ltimo VAO que he hecho glBindVertexArray
-		glBindBuffer(GL_ARRAY_BUFFER, vboHexaedro);
-
-		//Posicin X e Y del punto
-		GLfloat hexa[] =
-		{
-			-0.8f, +0.2f, -0.2f, // 3
-			-0.4f, +0.2f, -0.2f, // 2
-			-0.8f, -0.2f, -0.2f, // 6
-			-0.4f, -0.2f, -0.2f, // 7
-			-0.4f, -0.2f, +0.2f, // 4
-			-0.4f, +0.2f, -0.2f, // 2
-			-0.4f, +0.2f, +0.2f, // 0
-			-0.8f, +0.2f, -0.2f, // 3
-			-0.8f, +0.2f, +0.2f, // 1
-			-0.8f, -0.2f, -0.2f, // 6
-			-0.8f, -0.2f, +0.2f, // 5
-			-0.4f, -0.2f, +0.2f, // 4
-			-0.8f, +0.2f, +0.2f, // 1
-			-0.4f, +0.2f, +0.2f  // 0
-		};
-
-		//Definimos modo de dibujo para cada cara
-		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-
-		//Ponemos los valores en el VBO creado
-		glBufferData(GL_ARRAY_BUFFER, sizeof(hexa), hexa, GL_STATIC_DRAW);
-
-		//Indicamos donde almacenar y como esta distribuida la informacin
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid*)0);
-
-		//Indicamos que la tarjeta grfica puede usar el atributo 0
-		glEnableVertexAttribArray(0);
-
-		//Desvinculamos VBO
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-		//Desvinculamos VAOCubo
-		glBindVertexArray(0);
-		
-		//VBOTriangle
-
-		//Definimos cantidad de vao a crear y donde almacenarlos
-		glGenVertexArrays(1, &vaoPiramide);
-
-		//Indico que el VAO activo de la GPU es el que acabo de crear
-		glBindVertexArray(vaoPiramide);
-
-		//Definimos cantidad de vbo a crear y donde almacenarlos
-		glGenBuffers(1, &vboPentaedro);
-
-		//Indico que el VBO activo es el que acabo de crear y que almacenar un array. Todos los VBO que genere se asignaran al ltimo VAO que he hecho glBindVertexArray
-		glBindBuffer(GL_ARRAY_BUFFER, vboPentaedro);
+		//Mientras el driver compila y linka en sus hilos cargamos y subimos la geometria.
+		//La geometria viene de archivos .mesh mapeados en memoria: los bloques de vertices e indices se pasan
+		//tal cual a glBufferStorage. Varias tiras en una misma malla se separan con el indice de reinicio
+		MeshFile hexaedroFile, pentaedroFile;
+		if (!MapMeshFile("Hexaedro.mesh", hexaedroFile) || !MapMeshFile("Pentaedro.mesh", pentaedroFile)) {
+			UnmapMeshFile(hexaedroFile);
+			DestroyShaderRegistry(shaderRegistry);
+			DestroyPlatform(platform);
+			return EXIT_FAILURE;
+		}
 
-		GLfloat penta[] =
-		{
-			+0.4f, 0.0f,-0.5f, //1
-			+0.8f, 0.0f, -0.5f, //2
-			+0.4f, 0.0f, 0.0f, //3
-			+0.8f, 0.0f, 0.0f,//4
-			+0.6f, +0.3f, -0.25f,//5
-			+0.8f, 0.0f, -0.5f, //2
-			+0.4f, 0.0f,-0.5f, //1
-			+0.4f, 0.0f, 0.0f, //3
-			+0.6f, +0.3f, -0.25f,//5
-		};
+		glEnable(GL_PRIMITIVE_RESTART_FIXED_INDEX);
 
+		//Definimos modo de dibujo para cada cara
 		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
-		glBufferData(GL_ARRAY_BUFFER, sizeof(penta), penta, GL_STATIC_DRAW);
-
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), (GLvoid*)0);
-
-		glEnableVertexAttribArray(0);
+		//Las dos mallas comparten arena: un VAO, un VBO y un EBO para toda la escena, asi que cualquier mezcla de
+		//ellas se dibuja con un solo draw indirecto. Una vez subidas ya no hace falta el mapeo
+		MeshArena meshArena;
+		bool arenaCreated = CreateMeshArena(meshArena, { &hexaedroFile, &pentaedroFile });
+		std::cout << "Hexaedro: " << hexaedroFile.header->vertexCount << " vertices, " << hexaedroFile.header->indexCount << " indices" << std::endl;
+		std::cout << "Pentaedro: " << pentaedroFile.header->vertexCount << " vertices, " << pentaedroFile.header->indexCount << " indices" << std::endl;
+		UnmapMeshFile(hexaedroFile);
+		UnmapMeshFile(pentaedroFile);
+
+		if (!arenaCreated) {
+			DestroyShaderRegistry(shaderRegistry);
+			DestroyPlatform(platform);
+			return EXIT_FAILURE;
+		}
 
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		//Ahora si esperamos a los programas; solo cuenta como tiempo de shaders lo que no se ha solapado
+		bool compiledDuringLoad = IsProgramBatchReady(shaderRegistry, programBatch);
+		auto finishStart = std::chrono::steady_clock::now();
+		std::vector<GLuint> compiledPrograms = FinishPrograms(shaderRegistry, programBatch);
+		shadersMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - finishStart).count();
+		GLuint hexaedroCompiledProgram = compiledPrograms[0];
+		GLuint piramideCompiledProgram = compiledPrograms[1];
+		GLuint cullingCompiledProgram = gpuCullingEnabled ? compiledPrograms[2] : 0;
+
+		//Los errores de shaders ya no cierran la aplicacion, pero sin sus programas la escena no se puede dibujar
+		if (hexaedroCompiledProgram == 0 || piramideCompiledProgram == 0 || (gpuCullingEnabled && cullingCompiledProgram == 0)) {
+			std::cerr << "No se han podido crear los programas de la escena" << std::endl;
+			DestroyMeshArena(meshArena);
+			DestroyShaderRegistry(shaderRegistry);
+			DestroyPlatform(platform);
+			return EXIT_FAILURE;
+		}
 
-		//Desvinculamos VAO
-		glBindVertexArray(0);
+		bool warmStart = shaderRegistry.programsLinked == 0;
+		std::cout << "Shaders preparados en " << shadersMilliseconds << " ms (arranque en " << (warmStart ? "caliente" : "frio") << "): "
+			<< shaderRegistry.shadersCompiled << " shaders compilados, "
+			<< shaderRegistry.programsLinked << " programas linkados, "
+			<< shaderRegistry.programsFromDisk << " programas desde disco, "
+			<< shaderRegistry.duplicatesAvoided << " duplicados evitados"
+			<< (shaderRegistry.parallelCompile ? ", compilacion en paralelo" : "")
+			<< (shaderRegistry.parallelCompile && compiledDuringLoad ? " (terminada durante la carga de mallas)" : "") << std::endl;
+
+		//Vigilamos los archivos de los shaders para recargarlos sin reiniciar
+		ShaderWatcher shaderWatcher = CreateShaderWatcher();
+		WatchProgram(shaderWatcher, hexaedroProgram, &hexaedroCompiledProgram);
+		WatchProgram(shaderWatcher, piramideProgram, &piramideCompiledProgram);
+		if (gpuCullingEnabled)
+			WatchProgram(shaderWatcher, cullingProgram, &cullingCompiledProgram);
+
+		//Cachear localizaciones de los uniforms de cada programa
+		UniformLocations hexaedroUniforms = CacheUniformLocations(hexaedroCompiledProgram);
+		UniformLocations piramideUniforms = CacheUniformLocations(piramideCompiledProgram);
+
+		const Bounds& hexaedroBounds = meshArena.meshes[ARENA_HEXAEDRO].bounds;
+		const Bounds& pentaedroBounds = meshArena.meshes[ARENA_PENTAEDRO].bounds;
+
+		//SSBO persistente con las matrices de modelo de los objetos visibles y la primera matriz de cada draw,
+		//se rellena cada frame. Cada reserva puede perder hasta un alineamiento de relleno
+		GLint storageAlignment;
+		glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storageAlignment);
+		GLsizeiptr objectFrameSize = (SCENE_CROWD + crowd.size()) * sizeof(glm::mat4) + storageAlignment
+			+ DRAW_BATCH_COUNT * (meshArena.meshes.size() * sizeof(GLuint) + storageAlignment);
+		StreamBuffer objectStream = CreateStreamBuffer(GL_SHADER_STORAGE_BUFFER, objectFrameSize, storageAlignment);
+
+		//Comandos de los draws indirectos: como mucho uno por malla en cada lote, tenga los objetos que tenga
+		StreamBuffer indirectStream = CreateStreamBuffer(GL_DRAW_INDIRECT_BUFFER,
+			DRAW_BATCH_COUNT * meshArena.meshes.size() * sizeof(DrawElementsIndirectCommand), sizeof(DrawElementsIndirectCommand));
+		DrawBatch hexaedroBatch, piramideBatch;
+
+		//Con culling en GPU los hexaedros visibles y su comando solo existen en la GPU
+		GpuCulling gpuCulling;
+		if (gpuCullingEnabled)
+			gpuCulling = CreateGpuCulling(static_cast<GLuint>(2 + crowd.size()));
+
+		//Cola que ordena los draws del frame y cache del estado de GL que ya esta enlazado
+		RenderQueue renderQueue = CreateRenderQueue(OBJECT_TRANSFORMS_BINDING, DRAW_PARAMETERS_BINDING);
+		GLStateCache stateCache = CreateStateCache();
 
 		//Matrices de transformacion
 		cubo.position = glm::vec3(0.f, 0.f, 0.f);
@@ -460,6 +431,52 @@ void main() {
 		ortoedro.forward = glm::vec3(0.f,1.f,0.f);
 		ortoedro.forwardRotation = glm::vec3(0.f,0.f,1.f);
 
+		//Guardamos los objetos por comportamiento como estructura de arrays. El cubo y los hexaedros extra
+		//rebotan en Y entre -0.9 y 0.9 y el ortoedro escala entre 1 y 2
+		GameObjectArray hexaedros = CreateGameObjectArray(MOVE_POSITION, -0.9f, 0.9f, 1 + crowd.size());
+		size_t cuboIndex = AddGameObject(hexaedros, cubo);
+		for (const GameObject& hexaedro : crowd)
+			AddGameObject(hexaedros, hexaedro);
+
+		GameObjectArray ortoedros = CreateGameObjectArray(MOVE_SCALE, 1.f, 2.f);
+		size_t ortoedroIndex = AddGameObject(ortoedros, ortoedro);
+
+		//La piramide mantiene su condicion de rebote (>= 0.9 o <= 0.9), que se cumple en cada paso
+		GameObjectArray piramides = CreateGameObjectArray(MOVE_POSITION, 0.9f, 0.9f);
+		size_t piramideIndex = AddGameObject(piramides, piramide);
+
+		//Creamos el UBO persistente con la matriz de la camara
+		TransformBuffer transformBuffer = CreateTransformBuffer(TRANSFORM_SLOT_COUNT);
+
+		Camera camera;
+		camera.halfHeight = 1.f / cameraZoom;
+
+		//Matrices, esferas e indices visibles de los hexaedros extra, y cuantos visibles deja cada trozo del culling
+		std::vector<glm::mat4> crowdMatrices(crowd.size());
+		SphereArray crowdSpheres;
+		ResizeSphereArray(crowdSpheres, crowd.size());
+		std::vector<std::uint32_t> crowdVisible(crowd.size());
+		std::vector<size_t> crowdChunkVisible, crowdChunkOffsets;
+
+		//Cajas en espacio de mundo de todos los objetos y BVH sobre ellas para seleccionar con el raton
+		std::vector<Bounds> sceneBounds(SCENE_CROWD + crowd.size());
+		Bvh sceneBvh;
+		int bvhRebuilds = 0;
+		bool mouseWasPressed = false;
+
+		//Objetos enviados a la GPU frente a los que hay en la escena, acumulados para el resumen final
+		size_t submittedObjects = 0;
+		size_t sceneObjects = 0;
+		int renderedFrames = 0;
+
+		//El ultimo frame pudo reservar sus matrices; si no, el culling en GPU se lanzo con 0 objetos
+		bool lastFrameObjectsAllocated = false;
+
+		//Llamadas a glMultiDrawElementsIndirect y comandos que llevaban, tambien para el resumen
+		size_t multiDrawCalls = 0;
+		size_t indirectCommands = 0;
+
+
 		//bools for Inputs
 		bool wireframeMode = false;
 
@@ -467,18 +484,44 @@ void main() {
 		bool ortoedroRenderizado = true;
 		bool piramideRenderizada = true;
 
+		//Ultimo valor mostrado del contador de consultas de uniforms
+		int reportedUniformLookups = -1;
+
+		Profiler profiler = CreateProfiler(!profileOutput.empty());
+
+		//Hilos que simulan y generan las matrices; el de render solo consume el resultado
+		JobSystem jobSystem;
+		CreateJobSystem(jobSystem, workerCount);
+
+		//Tiempo pendiente de simular y tiempo del frame anterior
+		double simulationAccumulator = 0.0;
+		double previousFrameTime = GetPlatformTime(platform);
+
 		//Generamos el game loop
-		while (!glfwWindowShouldClose(window)) {
+		while (!PlatformShouldClose(platform)) {
+
+			BeginProfilerFrame(profiler);
+
+			//Reiniciamos el contador de consultas de uniforms del frame
+			uniformLookupsThisFrame = 0;
 
-			GLdouble screenSize[2];
-			glfwGetWindowSize(window, (int*)&screenSize[0], (int*)&screenSize[1]);
+			//Aplicamos las recargas de shaders en el limite del frame, antes de dibujar nada
+			BeginProfileScope(profiler, "Recargar shaders");
+			if (ApplyShaderReloads(shaderWatcher, shaderRegistry)) {
+				hexaedroUniforms = CacheUniformLocations(hexaedroCompiledProgram);
+				piramideUniforms = CacheUniformLocations(piramideCompiledProgram);
+
+				//Un programa nuevo puede tener el nombre de uno borrado que la cache cree activo
+				InvalidateStateCache(stateCache);
+			}
+			EndProfileScope(profiler);
 
-			glUniform2dv(glGetUniformLocation(cuboCompiledProgram, "windowSize"), 1, &screenSize[0]);
+			glm::vec2 windowSize = glm::vec2(platform.width, platform.height);
 
 			//Pulleamos los eventos (botones, teclas, mouse...)
-			glfwPollEvents();
+			PollPlatformEvents(platform);
 
-			if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS)
+			if (IsKeyPressed(platform, KEY_1))
 			{
 				if (wireframeMode) {
 					glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
@@ -488,29 +531,23 @@ void main() {
 				}
 				wireframeMode = !wireframeMode;
 			}
-			if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS)
+			if (IsKeyPressed(platform, KEY_2))
 				cuboRenderizado = !cuboRenderizado;
-			if (glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS)
+			if (IsKeyPressed(platform, KEY_3))
 				ortoedroRenderizado = !ortoedroRenderizado;
-			if (glfwGetKey(window, GLFW_KEY_4) == GLFW_PRESS)
+			if (IsKeyPressed(platform, KEY_4))
 				piramideRenderizada = !piramideRenderizada;
-			if (glfwGetKey(window, GLFW_KEY_M) == GLFW_PRESS)
+			if (IsKeyPressed(platform, KEY_M))
 			{
-				cubo.velocity += (cubo.velocity / 100) * 10;
-				cubo.angularVelocity += (cubo.angularVelocity/100)*10;
-				ortoedro.velocity += (ortoedro.velocity / 100) * 10;
-				ortoedro.angularVelocity += (ortoedro.angularVelocity / 100) * 10;
-				piramide.velocity += (piramide.velocity / 100) * 10;
-				piramide.angularVelocity += (piramide.angularVelocity / 100) * 10;
+				ScaleGameObjectVelocity(hexaedros, cuboIndex, 1.1f);
+				ScaleGameObjectVelocity(ortoedros, ortoedroIndex, 1.1f);
+				ScaleGameObjectVelocity(piramides, piramideIndex, 1.1f);
 			}
-			if (glfwGetKey(window, GLFW_KEY_N) == GLFW_PRESS)
+			if (IsKeyPressed(platform, KEY_N))
 			{
-				cubo.velocity -= (cubo.velocity / 100) * 10;
-				cubo.angularVelocity -= (cubo.angularVelocity / 100) * 10;
-				ortoedro.velocity -= (ortoedro.velocity / 100) * 10;
-				ortoedro.angularVelocity -= (ortoedro.angularVelocity / 100) * 10;
-				piramide.velocity -= (piramide.velocity / 100) * 10;
-				piramide.angularVelocity -= (piramide.angularVelocity / 100) * 10;
+				ScaleGameObjectVelocity(hexaedros, cuboIndex, 0.9f);
+				ScaleGameObjectVelocity(ortoedros, ortoedroIndex, 0.9f);
+				ScaleGameObjectVelocity(piramides, piramideIndex, 0.9f);
 			}
 
 
@@ -518,123 +555,344 @@ void main() {
 			//Limpiamos los buffers
 			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
-			//Cubo
-			glBindVertexArray(vaoCubo);
-			glUseProgram(cuboCompiledProgram);
-
-			
-			cubo.position += cubo.forward * cubo.velocity;
-			cubo.rotation.y += cubo.forwardRotation.y * cubo.angularVelocity;
-
-			if (cubo.position.y >= 0.9f || cubo.position.y <= -0.9f)
-				cubo.forward = -cubo.forward;
-
-			//Generar matrices
-			glm::mat4 cuboTranslationMatrix = GenerateTranslationMatrix(cubo.position);
-			glm::mat4 cuboRotationMatrix = GenerateRotationMatrix(cubo.rotation, cubo.rotation.y);
-			glm::mat4 cuboScaleMatrix = GenerateScaleMatrix(cubo.scale);
-			
-
-			//Pasar matrices
-			glUniformMatrix4fv(glGetUniformLocation(cuboCompiledProgram, "translationMatrix"), 1, GL_FALSE, glm::value_ptr(cuboTranslationMatrix));
-			glUniformMatrix4fv(glGetUniformLocation(cuboCompiledProgram, "rotationMatrix"), 1, GL_FALSE, glm::value_ptr(cuboRotationMatrix));
-			glUniformMatrix4fv(glGetUniformLocation(cuboCompiledProgram, "scaleMatrix"), 1, GL_FALSE, glm::value_ptr(cuboScaleMatrix));
-
-			//Paso los uniforms
-			glUniform2f(glGetUniformLocation(cuboCompiledProgram, "windowSize"), windowWidth, windowHeight);
-		
-
-			//Dibujo cubo
-			if(cuboRenderizado)
-				glDrawArrays(GL_TRIANGLE_STRIP, 0, 14);
+			BeginProfileScope(profiler, "Actualizar");
+
+			//Acumulamos el tiempo real y lo consumimos en pasos fijos, independientes de los FPS
+			double frameTime = GetPlatformTime(platform);
+			simulationAccumulator += frameTime - previousFrameTime;
+			previousFrameTime = frameTime;
+
+			int simulationSteps = 0;
+			while (simulationAccumulator >= SIMULATION_STEP && simulationSteps < MAX_SIMULATION_STEPS) {
+				ParallelFor(jobSystem, hexaedros.count, SIMULATION_JOB_GRAIN, [&hexaedros](size_t begin, size_t end) {
+					SimulateGameObjectRange(hexaedros, begin, end);
+				});
+				SimulateGameObjects(ortoedros);
+				SimulateGameObjects(piramides);
+				simulationAccumulator -= SIMULATION_STEP;
+				simulationSteps++;
+			}
 
-			//ortoedro
-			glUseProgram(ortoedroCompiledProgram);
+			//Si no hemos podido ponernos al dia descartamos el retraso
+			simulationAccumulator = std::min(simulationAccumulator, SIMULATION_STEP);
+
+			//Dibujamos entre los dos ultimos pasos segun el tiempo que queda en el acumulador
+			float alpha = static_cast<float>(simulationAccumulator / SIMULATION_STEP);
+			GameObject cuboRender = InterpolateGameObject(hexaedros, cuboIndex, alpha);
+			GameObject ortoedroRender = InterpolateGameObject(ortoedros, ortoedroIndex, alpha);
+			GameObject piramideRender = InterpolateGameObject(piramides, piramideIndex, alpha);
+
+			//Generar matrices de modelo (rotacion * traslacion * escala) en una sola pasada
+			glm::mat4 cuboModelMatrix = ComposeModelMatrix(cuboRender.position, cuboRender.rotation, cuboRender.rotation.y, cuboRender.scale);
+			glm::mat4 ortoedroModelMatrix = ComposeModelMatrix(ortoedroRender.position, ortoedroRender.rotation, ortoedroRender.rotation.z, ortoedroRender.scale);
+
+			//La piramide rota en X y despues en Y
+			glm::mat3 piramideRotation = EulerRotation(glm::vec3(piramideRender.rotation.x, piramideRender.rotation.y, 0.f));
+			glm::mat4 piramideModelMatrix = ComposeModelMatrix(piramideRender.position, piramideRotation, piramideRender.scale);
+
+			EndProfileScope(profiler);
+
+			//Culling contra el frustum de la camara antes de enviar nada. Los objetos sueltos prueban su caja
+			BeginProfileScope(profiler, "Culling");
+			glm::mat4 viewProjection = CameraViewProjection(camera);
+			Frustum frustum = ExtractFrustum(viewProjection);
+
+			//Con culling en GPU los hexaedros se prueban en el compute shader y aqui solo se quitan los ocultos con las teclas
+			bool cuboVisible = cuboRenderizado && (gpuCullingEnabled || IsBoxVisible(frustum, hexaedroBounds, cuboModelMatrix));
+			bool ortoedroVisible = ortoedroRenderizado && (gpuCullingEnabled || IsBoxVisible(frustum, hexaedroBounds, ortoedroModelMatrix));
+			bool piramideVisible = piramideRenderizada && IsBoxVisible(frustum, pentaedroBounds, piramideModelMatrix);
+
+			//Los hexaedros extra se reparten por trozos: cada trabajo compone las matrices de su trozo, calcula sus
+			//esferas y las prueba por lotes SIMD, dejando los indices visibles al principio de su hueco
+			size_t crowdCount = hexaedros.count - (cuboIndex + 1);
+			size_t crowdChunks = (crowdCount + CULL_JOB_GRAIN - 1) / CULL_JOB_GRAIN;
+			crowdChunkVisible.resize(crowdChunks);
+			crowdChunkOffsets.resize(crowdChunks);
+			ParallelFor(jobSystem, crowdChunks, 1, [&](size_t begin, size_t end) {
+				for (size_t chunk = begin; chunk < end; chunk++) {
+					size_t first = chunk * CULL_JOB_GRAIN;
+					size_t last = std::min(first + CULL_JOB_GRAIN, crowdCount);
+					for (size_t i = first; i < last; i++) {
+						GameObject hexaedroRender = InterpolateGameObject(hexaedros, cuboIndex + 1 + i, alpha);
+						crowdMatrices[i] = ComposeModelMatrix(hexaedroRender.position, hexaedroRender.rotation, hexaedroRender.rotation.y, hexaedroRender.scale);
+
+						Bounds& bounds = sceneBounds[SCENE_CROWD + i];
+						bounds = TransformBounds(hexaedroBounds, crowdMatrices[i]);
+						SetSphere(crowdSpheres, i, bounds.center, bounds.radius);
+					}
+					crowdChunkVisible[chunk] = gpuCullingEnabled ? 0 : CullSpheres(frustum, crowdSpheres, first, last, crowdVisible.data() + first);
+				}
+			});
 
+			size_t crowdVisibleCount = 0;
+			for (size_t chunk = 0; chunk < crowdChunks; chunk++) {
+				crowdChunkOffsets[chunk] = crowdVisibleCount;
+				crowdVisibleCount += crowdChunkVisible[chunk];
+			}
+			EndProfileScope(profiler);
+
+			//Los objetos se mueven cada paso: ajustamos las cajas del BVH en vez de reconstruirlo, salvo que se haya degradado
+			BeginProfileScope(profiler, "BVH");
+			sceneBounds[SCENE_CUBO] = TransformBounds(hexaedroBounds, cuboModelMatrix);
+			sceneBounds[SCENE_ORTOEDRO] = TransformBounds(hexaedroBounds, ortoedroModelMatrix);
+			sceneBounds[SCENE_PIRAMIDE] = TransformBounds(pentaedroBounds, piramideModelMatrix);
+			if (!sceneBvh.nodes.empty())
+				RefitBvh(sceneBvh, sceneBounds);
+			if (sceneBvh.nodes.empty() || ComputeBvhCost(sceneBvh) > sceneBvh.builtCost * BVH_REBUILD_RATIO) {
+				BuildBvh(sceneBvh, sceneBounds);
+				bvhRebuilds++;
+			}
 
-			ortoedro.scale += ortoedro.forward * ortoedro.velocity;
-			ortoedro.rotation.z += ortoedro.forwardRotation.z * ortoedro.angularVelocity;
+			//Al hacer clic lanzamos un rayo desde la camara por el cursor y nos quedamos con la caja mas cercana
+			double mouseX, mouseY;
+			bool mousePressed = IsMouseButtonPressed(platform, mouseX, mouseY);
+			if (mousePressed && !mouseWasPressed) {
+				glm::vec2 ndc(static_cast<float>(mouseX / platform.width) * 2.f - 1.f, 1.f - static_cast<float>(mouseY / platform.height) * 2.f);
+				glm::vec3 rayOrigin, rayDirection;
+				CameraRay(camera, ndc, rayOrigin, rayDirection);
+
+				std::uint32_t hitItem;
+				float hitDistance;
+				if (RaycastBvh(sceneBvh, sceneBounds, rayOrigin, rayDirection, hitItem, hitDistance)) {
+					const char* names[] = { "cubo", "ortoedro", "piramide" };
+					std::cout << "Seleccionado: ";
+					if (hitItem < SCENE_CROWD)
+						std::cout << names[hitItem];
+					else
+						std::cout << "hexaedro " << hitItem - SCENE_CROWD;
+					std::cout << " a distancia " << hitDistance << std::endl;
+				}
+			}
+			mouseWasPressed = mousePressed;
+			EndProfileScope(profiler);
+
+			//Escribimos la camara en el UBO y las matrices de modelo ya compuestas en el SSBO, una sola vez por frame
+			BeginProfileScope(profiler, "Subir transformaciones");
+			BeginTransformFrame(transformBuffer);
+			WriteModelMatrix(transformBuffer, CAMERA_SLOT, viewProjection);
+
+			//Juntamos las matrices de los objetos visibles: primero los hexaedros y detras la piramide. Se escriben
+			//directamente en la region del frame del buffer persistente, sin vector intermedio ni glBufferSubData.
+			//Con culling en GPU van todos los hexaedros y el compute shader elige
+			size_t hexaedroCount = (cuboVisible ? 1 : 0) + (ortoedroVisible ? 1 : 0) + (gpuCullingEnabled ? crowdCount : crowdVisibleCount);
+			size_t objectCount = hexaedroCount + (piramideVisible ? 1 : 0);
+			BeginStreamFrame(objectStream);
+			BeginStreamFrame(indirectStream);
+			StreamAllocation objects = AllocateStream(objectStream, objectCount * sizeof(glm::mat4));
+			glm::mat4* objectTransforms = reinterpret_cast<glm::mat4*>(objects.data);
+			BufferRange objectRange = { objectStream.buffer, objects.offset, objects.size };
+
+			size_t crowdInstance = 0;
+			if (objectTransforms != nullptr) {
+				if (cuboVisible)
+					objectTransforms[crowdInstance++] = cuboModelMatrix;
+				if (ortoedroVisible)
+					objectTransforms[crowdInstance++] = ortoedroModelMatrix;
+
+				//Los hexaedros extra visibles van despues del cubo; cada trozo copia los suyos a partir de su offset
+				ParallelFor(jobSystem, crowdChunks, 1, [&](size_t begin, size_t end) {
+					for (size_t chunk = begin; chunk < end; chunk++) {
+						if (gpuCullingEnabled) {
+							size_t first = chunk * CULL_JOB_GRAIN;
+							size_t last = std::min(first + CULL_JOB_GRAIN, crowdCount);
+							std::copy(crowdMatrices.begin() + first, crowdMatrices.begin() + last, objectTransforms + crowdInstance + first);
+							continue;
+						}
+
+						const std::uint32_t* visible = crowdVisible.data() + chunk * CULL_JOB_GRAIN;
+						glm::mat4* destination = objectTransforms + crowdInstance + crowdChunkOffsets[chunk];
+						for (size_t i = 0; i < crowdChunkVisible[chunk]; i++)
+							destination[i] = crowdMatrices[visible[i]];
+					}
+				});
+
+				if (piramideVisible)
+					objectTransforms[hexaedroCount] = piramideModelMatrix;
+			}
 
+			//Un draw por malla en el lote de su programa, apuntando a la primera de sus matrices. Todos los hexaedros
+			//son instancias de un mismo draw, asi que el numero de comandos no crece con la escena
+			ClearDrawBatch(hexaedroBatch);
+			ClearDrawBatch(piramideBatch);
+			if (objectTransforms != nullptr) {
+				if (!gpuCullingEnabled)
+					AddDraw(hexaedroBatch, meshArena, ARENA_HEXAEDRO, static_cast<GLuint>(hexaedroCount), 0);
+				if (piramideVisible)
+					AddDraw(piramideBatch, meshArena, ARENA_PENTAEDRO, 1, static_cast<GLuint>(hexaedroCount));
+			}
+			EndProfileScope(profiler);
+
+			//El compute shader compacta los hexaedros visibles y escribe su comando. Sin matrices este frame se
+			//lanza igual con 0 objetos para que el comando no se quede con las instancias del anterior
+			if (gpuCullingEnabled) {
+				BeginProfileScope(profiler, "Culling en GPU", true);
+				DispatchGpuCulling(gpuCulling, stateCache, cullingCompiledProgram, frustum, meshArena.meshes[ARENA_HEXAEDRO],
+					objectStream.buffer, objects.offset, objectTransforms != nullptr ? static_cast<GLuint>(hexaedroCount) : 0);
+				EndProfileScope(profiler);
+			}
 
-			if (ortoedro.scale.y <= 1.f || ortoedro.scale.y >= 2.f)
-				ortoedro.forward = -ortoedro.forward;
+			submittedObjects += objectCount;
+			sceneObjects += crowdCount + 3;
+			renderedFrames++;
+			lastFrameObjectsAllocated = objectTransforms != nullptr;
 
-			glm::mat4 ortoedroTranslationMatrix = GenerateTranslationMatrix(ortoedro.position);
-			glm::mat4 ortoedroRotationMatrix = GenerateRotationMatrix(ortoedro.rotation, ortoedro.rotation.z);
-			glm::mat4 ortoedroScaleMatrix = GenerateScaleMatrix(ortoedro.scale);
+			//La camara es la misma para todos los programas
+			BindModelMatrix(stateCache, transformBuffer, CAMERA_SLOT, CAMERA_BLOCK_BINDING);
 
-			glUniformMatrix4fv(glGetUniformLocation(ortoedroCompiledProgram, "translationMatrix"), 1, GL_FALSE, glm::value_ptr(ortoedroTranslationMatrix));
-			glUniformMatrix4fv(glGetUniformLocation(ortoedroCompiledProgram, "rotationMatrix"), 1, GL_FALSE, glm::value_ptr(ortoedroRotationMatrix));
-			glUniformMatrix4fv(glGetUniformLocation(ortoedroCompiledProgram, "scaleMatrix"), 1, GL_FALSE, glm::value_ptr(ortoedroScaleMatrix));
+			//Cada programa deja su draw indirecto en la cola con su material. La cola los ordena por capa, programa,
+			//VAO, material y profundidad, y al lanzarlos la cache se salta el estado que ya esta enlazado
+			ClearRenderQueue(renderQueue);
 
-			glUniform2f(glGetUniformLocation(ortoedroCompiledProgram, "windowSize"), windowWidth, windowHeight);
+			float currentTime = static_cast<float>(GetPlatformTime(platform));
 
+			Material hexaedroMaterial, piramideMaterial;
+			SetMaterialUniform(hexaedroMaterial, hexaedroUniforms.windowSize, windowSize);
+			SetMaterialUniform(piramideMaterial, piramideUniforms.windowSize, windowSize);
+			SetMaterialUniform(piramideMaterial, piramideUniforms.time, currentTime);
 
-			if (ortoedroRenderizado)
-				glDrawArrays(GL_TRIANGLE_STRIP, 0, 14);
+			//Cubo, ortoedro y hexaedros extra. Con culling en GPU el comando y las matrices los ha escrito el compute shader
+			RenderCommand hexaedroCommand;
+			bool hexaedroQueued = false;
+			if (gpuCullingEnabled) {
+				hexaedroCommand = GpuCulledCommand(gpuCulling, meshArena);
+				hexaedroQueued = true;
+			}
+			else if (WriteDrawBatch(hexaedroBatch, meshArena, indirectStream, objectStream, hexaedroCommand)) {
+				hexaedroCommand.transforms = objectRange;
+				hexaedroQueued = true;
+			}
 
+			if (hexaedroQueued) {
+				hexaedroCommand.program = hexaedroCompiledProgram;
+				hexaedroCommand.layer = LAYER_HEXAEDROS;
+				hexaedroCommand.material = AddMaterial(renderQueue, hexaedroMaterial);
+				PushRenderCommand(renderQueue, hexaedroCommand);
+			}
 
 			//Piramide
-			glBindVertexArray(vaoPiramide);
-			glUseProgram(piramideCompiledProgram);
-
-			//Matrices de transformacion
-
-			//generar matrices
-
-			piramide.position += piramide.forward * piramide.velocity;
-			piramide.rotation.x += piramide.forwardRotation.x * piramide.angularVelocity;
-			piramide.rotation.y += piramide.forwardRotation.y * piramide.angularVelocity;
-
-			if (piramide.position.y >= 0.9f || piramide.position.y <= 0.9f)
-				piramide.forward = -piramide.forward;
-
-			glm::mat4 piramideTranslationMatrix = GenerateTranslationMatrix(piramide.position);
-			glm::mat4 piramideScaleMatrix = GenerateScaleMatrix(piramide.scale);
+			RenderCommand piramideCommand;
+			if (WriteDrawBatch(piramideBatch, meshArena, indirectStream, objectStream, piramideCommand)) {
+				piramideCommand.program = piramideCompiledProgram;
+				piramideCommand.transforms = objectRange;
+				piramideCommand.layer = LAYER_PIRAMIDE;
+				piramideCommand.material = AddMaterial(renderQueue, piramideMaterial);
+				piramideCommand.depth = ProjectedDepth(viewProjection, sceneBounds[SCENE_PIRAMIDE].center);
+				PushRenderCommand(renderQueue, piramideCommand);
+			}
 
-			glm::mat4 rotationX = GenerateRotationMatrix(glm::vec3(1.0f, 0.0f, 0.0f), piramide.rotation.x);
-			glm::mat4 rotationY = GenerateRotationMatrix(glm::vec3(0.0f, 1.0f, 0.0f), piramide.rotation.y);
+			SortRenderQueue(renderQueue);
 
-			glm::mat4 piramideRotationMatrix = rotationX * rotationY;
+			BeginProfileScope(profiler, "Dibujar", true);
+			ExecuteRenderQueue(renderQueue, stateCache);
+			EndProfileScope(profiler);
 
-			glUniformMatrix4fv(glGetUniformLocation(piramideCompiledProgram, "translationMatrix"), 1, GL_FALSE, glm::value_ptr(piramideTranslationMatrix));
-			glUniformMatrix4fv(glGetUniformLocation(piramideCompiledProgram, "rotationMatrix"), 1, GL_FALSE, glm::value_ptr(piramideRotationMatrix));
-			glUniformMatrix4fv(glGetUniformLocation(piramideCompiledProgram, "scaleMatrix"), 1, GL_FALSE, glm::value_ptr(piramideScaleMatrix));
+			multiDrawCalls += renderQueue.commands.size();
+			for (const RenderCommand& command : renderQueue.commands)
+				indirectCommands += command.drawCount;
 
-			//Paso los uniforms
-			
-			glUniform2f(glGetUniformLocation(piramideCompiledProgram, "windowSize"), windowWidth, windowHeight);
+			//Protegemos las regiones usadas en este frame hasta que la GPU termine de leerlas
+			EndStreamFrame(indirectStream);
+			EndStreamFrame(objectStream);
+			EndTransformFrame(transformBuffer);
 
-			GLuint timeLocation = glGetUniformLocation(piramideCompiledProgram, "time");
+			//Mostramos las consultas de uniforms por frame cuando cambian (deberian ser 0)
+			if (uniformLookupsThisFrame != reportedUniformLookups) {
+				std::cout << "Consultas glGetUniformLocation por frame: " << uniformLookupsThisFrame << std::endl;
+				reportedUniformLookups = uniformLookupsThisFrame;
+			}
 
-			float currentTime = glfwGetTime();
 
-			glUniform1f(timeLocation, currentTime);
+			//Cambiamos buffers
+			BeginProfileScope(profiler, "Presentar");
+			PresentFrame(platform);
+			EndProfileScope(profiler);
 
-			//Dibujo piramide
-			if(piramideRenderizada)
-				glDrawArrays(GL_TRIANGLE_STRIP, 0, 9);
+			EndProfilerFrame(profiler);
+		}
 
+		//Informe de tiempos y traza para chrome://tracing
+		if (profiler.enabled) {
+			ResolveProfilerQueries(profiler);
+			PrintProfilerReport(profiler);
+			if (!WriteChromeTrace(profiler, profileOutput))
+				std::cerr << "No se ha podido guardar la traza en " << profileOutput << std::endl;
+		}
+		DestroyProfiler(profiler);
+		DestroyJobSystem(jobSystem);
+
+		//Con culling en GPU la CPU envia todos los hexaedros y no sabe cuantos se dibujan
+		if (renderedFrames > 0 && !gpuCullingEnabled)
+			std::cout << "Culling: " << submittedObjects / renderedFrames << " de " << sceneObjects / renderedFrames << " objetos enviados por frame" << std::endl;
+		std::cout << "BVH de la escena: " << sceneBvh.nodes.size() << " nodos, " << bvhRebuilds << " construcciones en " << renderedFrames << " frames" << std::endl;
+
+		if (renderedFrames > 0)
+			std::cout << "Draws indirectos: " << static_cast<double>(multiDrawCalls) / renderedFrames << " glMultiDrawElementsIndirect con "
+				<< static_cast<double>(indirectCommands) / renderedFrames << " comandos por frame" << std::endl;
+
+		//Llamadas de estado (programa, VAO, buffers y uniforms) que se han hecho frente a las que la cache ha evitado
+		if (renderedFrames > 0)
+			std::cout << "Estado de GL: " << static_cast<double>(stateCache.issuedCalls) / renderedFrames << " llamadas hechas y "
+				<< static_cast<double>(stateCache.skippedCalls) / renderedFrames << " evitadas por frame" << std::endl;
+
+		//Si la CPU ha tenido que esperar a la GPU, FRAMES_IN_FLIGHT se queda corto para esta escena
+		std::cout << "Buffer de objetos: " << objectStream.peakUsage / 1024 << " KB por frame, " << objectStream.stalls
+			<< " esperas a la GPU, " << objectStream.overflows << " reservas sin sitio" << std::endl;
+
+		//Repetimos la prueba de esferas del ultimo frame en la CPU (la camara no se mueve y las esferas siguen
+		//calculadas) y la comparamos con el contador que dejo el compute shader. Las esferas que casi tocan un
+		//plano pueden caer a cualquier lado segun el redondeo, asi que cada una admite una diferencia de 1
+		if (gpuCullingEnabled && renderedFrames > 0 && !lastFrameObjectsAllocated) {
+			std::cout << "Culling en GPU: el ultimo frame no tuvo sitio para sus matrices, no se compara con la CPU" << std::endl;
+		}
+		else if (gpuCullingEnabled && renderedFrames > 0) {
+			Frustum frustum = ExtractFrustum(CameraViewProjection(camera));
+			size_t crowdCount = hexaedros.count - (cuboIndex + 1);
+			size_t cpuVisible = CullSpheres(frustum, crowdSpheres, 0, crowdCount, crowdVisible.data());
+			size_t borderline = 0;
+			for (size_t i = 0; i < crowdCount; i++) {
+				glm::vec3 center(crowdSpheres.centerX[i], crowdSpheres.centerY[i], crowdSpheres.centerZ[i]);
+				borderline += IsSphereNearFrustumBoundary(frustum, center, crowdSpheres.radius[i], GPU_CULL_COMPARE_EPSILON) ? 1 : 0;
+			}
+			for (int object : { SCENE_CUBO, SCENE_ORTOEDRO }) {
+				bool rendered = object == SCENE_CUBO ? cuboRenderizado : ortoedroRenderizado;
+				if (!rendered)
+					continue;
+
+				const Bounds& bounds = sceneBounds[object];
+				cpuVisible += IsSphereVisible(frustum, bounds.center, bounds.radius) ? 1 : 0;
+				borderline += IsSphereNearFrustumBoundary(frustum, bounds.center, bounds.radius, GPU_CULL_COMPARE_EPSILON) ? 1 : 0;
+			}
 
-			//Cambiamos buffers
-			glFlush();
-			glfwSwapBuffers(window);
+			GLuint gpuVisible = ReadGpuVisibleCount(gpuCulling);
+			size_t difference = gpuVisible > cpuVisible ? gpuVisible - cpuVisible : cpuVisible - gpuVisible;
+			std::cout << "Culling en GPU: " << gpuVisible << " de " << crowdCount + 2 << " hexaedros visibles en el ultimo frame (CPU: " << cpuVisible
+				<< ", " << borderline << " en el borde)" << std::endl;
+			if (difference > borderline) {
+				std::cerr << "El culling en GPU no coincide con el de la CPU" << std::endl;
+				gpuCullingValid = false;
+			}
 		}
 
 		//Desactivar y eliminar programa
 		glUseProgram(0);
-		glDeleteProgram(cuboCompiledProgram);
-		glDeleteProgram(ortoedroCompiledProgram);
-		glDeleteProgram(piramideCompiledProgram);
-		
+		DestroyShaderWatcher(shaderWatcher);
+		DestroyShaderRegistry(shaderRegistry);
+
+		//Eliminamos los buffers y VAOs
+		DestroyStreamBuffer(indirectStream);
+		DestroyStreamBuffer(objectStream);
+		DestroyMeshArena(meshArena);
+		DestroyGpuCulling(gpuCulling);
 
+		//Liberamos el buffer de transformaciones
+		DestroyTransformBuffer(transformBuffer);
 
+		//Cerramos la ventana y el contexto
+		DestroyPlatform(platform);
 	}
 	else {
-		std::cout << "Fallo" << std::endl;
-		glfwTerminate();
+		return EXIT_FAILURE;
 	}
 
-	//Finalizamos GLFW
-	glfwTerminate();
+	return gpuCullingValid ? 0 : EXIT_FAILURE;
 }
\ No newline at end of file
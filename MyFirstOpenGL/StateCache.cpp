@@ -0,0 +1,73 @@
+#include "StateCache.h"
+
+
+GLStateCache CreateStateCache() {
+
+	GLStateCache cache;
+	InvalidateStateCache(cache);
+	return cache;
+}
+
+
+void InvalidateStateCache(GLStateCache& cache) {
+
+	cache.program = STATE_CACHE_UNKNOWN;
+	cache.vertexArray = STATE_CACHE_UNKNOWN;
+	cache.drawIndirectBuffer = STATE_CACHE_UNKNOWN;
+	for (int i = 0; i < STATE_CACHE_MAX_BINDINGS; i++) {
+		cache.storageBuffers[i].buffer = STATE_CACHE_UNKNOWN;
+		cache.uniformBuffers[i].buffer = STATE_CACHE_UNKNOWN;
+	}
+}
+
+
+//Devuelve true si hay que hacer la llamada y deja el valor nuevo en la cache
+bool UpdateCachedName(GLStateCache& cache, GLuint& current, GLuint value) {
+
+	if (current == value) {
+		cache.skippedCalls++;
+		return false;
+	}
+
+	current = value;
+	cache.issuedCalls++;
+	return true;
+}
+
+
+void CachedUseProgram(GLStateCache& cache, GLuint program) {
+
+	if (UpdateCachedName(cache, cache.program, program))
+		glUseProgram(program);
+}
+
+
+void CachedBindVertexArray(GLStateCache& cache, GLuint vertexArray) {
+
+	if (UpdateCachedName(cache, cache.vertexArray, vertexArray))
+		glBindVertexArray(vertexArray);
+}
+
+
+void CachedBindDrawIndirectBuffer(GLStateCache& cache, GLuint buffer) {
+
+	if (UpdateCachedName(cache, cache.drawIndirectBuffer, buffer))
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, buffer);
+}
+
+
+void CachedBindBufferRange(GLStateCache& cache, GLenum target, GLuint index, const BufferRange& range) {
+
+	BufferRange* bindings = target == GL_UNIFORM_BUFFER ? cache.uniformBuffers : target == GL_SHADER_STORAGE_BUFFER ? cache.storageBuffers : nullptr;
+	if (bindings != nullptr && index < STATE_CACHE_MAX_BINDINGS) {
+		BufferRange& current = bindings[index];
+		if (current.buffer == range.buffer && current.offset == range.offset && current.size == range.size) {
+			cache.skippedCalls++;
+			return;
+		}
+		current = range;
+	}
+
+	cache.issuedCalls++;
+	glBindBufferRange(target, index, range.buffer, range.offset, range.size);
+}
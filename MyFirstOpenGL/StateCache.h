@@ -0,0 +1,48 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstddef>
+
+//Puntos de binding indexados (SSBO y UBO) que sigue la cache
+#define STATE_CACHE_MAX_BINDINGS 8
+
+//Valor que no coincide con ningun objeto de GL: obliga a hacer la siguiente llamada
+#define STATE_CACHE_UNKNOWN 0xFFFFFFFFu
+
+//Trozo de un buffer tal y como se pasa a glBindBufferRange
+struct BufferRange
+{
+	GLuint buffer = 0;
+	GLintptr offset = 0;
+	GLsizeiptr size = 0;
+};
+
+//Estado de GL enlazado ahora mismo, para no repetir llamadas que no cambian nada. Solo es fiable si todo el
+//codigo que toca este estado pasa por aqui; si no, hay que invalidarla (p.ej. al recargar shaders, porque un
+//programa nuevo puede reutilizar el nombre de uno borrado)
+struct GLStateCache
+{
+	GLuint program = STATE_CACHE_UNKNOWN;
+	GLuint vertexArray = STATE_CACHE_UNKNOWN;
+	GLuint drawIndirectBuffer = STATE_CACHE_UNKNOWN;
+	BufferRange storageBuffers[STATE_CACHE_MAX_BINDINGS];
+	BufferRange uniformBuffers[STATE_CACHE_MAX_BINDINGS];
+
+	//Llamadas hechas y evitadas. Quien las lee las pone a 0 cuando quiera
+	size_t issuedCalls = 0;
+	size_t skippedCalls = 0;
+};
+
+GLStateCache CreateStateCache();
+
+//Olvida el estado conocido: la siguiente llamada de cada tipo se hace siempre
+void InvalidateStateCache(GLStateCache& cache);
+
+void CachedUseProgram(GLStateCache& cache, GLuint program);
+
+void CachedBindVertexArray(GLStateCache& cache, GLuint vertexArray);
+
+void CachedBindDrawIndirectBuffer(GLStateCache& cache, GLuint buffer);
+
+//target es GL_SHADER_STORAGE_BUFFER o GL_UNIFORM_BUFFER. Los puntos a partir de STATE_CACHE_MAX_BINDINGS se enlazan sin cache
+void CachedBindBufferRange(GLStateCache& cache, GLenum target, GLuint index, const BufferRange& range);
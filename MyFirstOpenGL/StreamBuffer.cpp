@@ -0,0 +1,90 @@
+#include "StreamBuffer.h"
+#include <algorithm>
+
+
+StreamBuffer CreateStreamBuffer(GLenum target, GLsizeiptr frameSize, GLsizeiptr alignment) {
+
+	StreamBuffer stream;
+	stream.target = target;
+	stream.alignment = std::max<GLsizeiptr>(alignment, 1);
+
+	//Cada region empieza alineada para que la primera reserva del frame tambien lo este
+	stream.frameSize = (std::max<GLsizeiptr>(frameSize, 1) + stream.alignment - 1) / stream.alignment * stream.alignment;
+
+	//Buffer inmutable mapeado una unica vez para toda la ejecucion. Al ser coherente no hace falta glFlushMappedBufferRange
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glGenBuffers(1, &stream.buffer);
+	glBindBuffer(target, stream.buffer);
+	glBufferStorage(target, stream.frameSize * FRAMES_IN_FLIGHT, nullptr, flags);
+	stream.mappedData = static_cast<GLubyte*>(glMapBufferRange(target, 0, stream.frameSize * FRAMES_IN_FLIGHT, flags));
+	glBindBuffer(target, 0);
+
+	return stream;
+}
+
+
+void BeginStreamFrame(StreamBuffer& stream) {
+
+	//Esperamos a que la GPU haya terminado con la region que vamos a sobrescribir
+	GLsync& fence = stream.fences[stream.currentFrame];
+	if (fence != nullptr) {
+		if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+			stream.stalls++;
+			while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {}
+		}
+		glDeleteSync(fence);
+		fence = nullptr;
+	}
+
+	stream.head = 0;
+}
+
+
+StreamAllocation AllocateStream(StreamBuffer& stream, GLsizeiptr size) {
+
+	StreamAllocation allocation;
+	GLsizeiptr alignedSize = (size + stream.alignment - 1) / stream.alignment * stream.alignment;
+
+	//Si no cabe no se reserva nada: quien llama decide si lo deja para otro frame o lo descarta
+	if (stream.mappedData == nullptr || size <= 0 || alignedSize > stream.frameSize - stream.head) {
+		stream.overflows += size > 0 ? 1 : 0;
+		return allocation;
+	}
+
+	allocation.offset = stream.frameSize * stream.currentFrame + stream.head;
+	allocation.data = stream.mappedData + allocation.offset;
+	allocation.size = size;
+
+	stream.head += alignedSize;
+	stream.peakUsage = std::max(stream.peakUsage, stream.head);
+	return allocation;
+}
+
+
+void EndStreamFrame(StreamBuffer& stream) {
+
+	//Marcamos el final de los comandos que leen esta region y pasamos a la siguiente
+	stream.fences[stream.currentFrame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	stream.currentFrame = (stream.currentFrame + 1) % FRAMES_IN_FLIGHT;
+}
+
+
+void DestroyStreamBuffer(StreamBuffer& stream) {
+
+	for (GLsync& fence : stream.fences) {
+		if (fence != nullptr) {
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+	}
+
+	if (stream.buffer != 0) {
+		glBindBuffer(stream.target, stream.buffer);
+		glUnmapBuffer(stream.target);
+		glBindBuffer(stream.target, 0);
+		glDeleteBuffers(1, &stream.buffer);
+	}
+
+	stream.buffer = 0;
+	stream.mappedData = nullptr;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <GL/glew.h>
+
+//Frames que la CPU puede adelantarse a la GPU escribiendo en buffers persistentes
+#define FRAMES_IN_FLIGHT 3
+
+//Buffer para datos que cambian cada frame (transformaciones, instancias, particulas, lineas de debug, UI...).
+//Se crea con glBufferStorage y se mapea una sola vez de forma persistente y coherente, asi que escribir es un
+//memcpy sin llamadas a GL. Se divide en FRAMES_IN_FLIGHT regiones de frameSize bytes; cada frame reparte la
+//suya como un allocator lineal y una fence impide volver a ella hasta que la GPU ha terminado de leerla
+struct StreamBuffer
+{
+	GLuint buffer = 0;
+	GLenum target = GL_ARRAY_BUFFER;
+	GLubyte* mappedData = nullptr;
+	GLsizeiptr frameSize = 0;
+	GLsizeiptr alignment = 1;
+	GLsizeiptr head = 0;
+	int currentFrame = 0;
+	GLsync fences[FRAMES_IN_FLIGHT] = {};
+
+	//Frames en los que hubo que esperar a la GPU y reservas que no cabian en la region
+	int stalls = 0;
+	int overflows = 0;
+	GLsizeiptr peakUsage = 0;
+};
+
+//Bloque reservado en la region del frame actual. offset es desde el inicio del buffer, listo para
+//glBindBufferRange, glBindVertexBuffer o como instancia base. data es nullptr si no habia sitio
+struct StreamAllocation
+{
+	GLubyte* data = nullptr;
+	GLintptr offset = 0;
+	GLsizeiptr size = 0;
+};
+
+//alignment es el alineamiento de cada reserva (p.ej. GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT o el tamano de un vertice)
+StreamBuffer CreateStreamBuffer(GLenum target, GLsizeiptr frameSize, GLsizeiptr alignment);
+
+//Espera a que la GPU suelte la region del frame y la deja vacia. Llamar antes de la primera reserva del frame
+void BeginStreamFrame(StreamBuffer& stream);
+
+StreamAllocation AllocateStream(StreamBuffer& stream, GLsizeiptr size);
+
+//Pone la fence detras de los comandos que leen la region y pasa a la siguiente. Llamar despues del ultimo draw que la usa
+void EndStreamFrame(StreamBuffer& stream);
+
+void DestroyStreamBuffer(StreamBuffer& stream);